@@ -0,0 +1,55 @@
+#ifndef LATRUNCULI_BATCH_H
+#define LATRUNCULI_BATCH_H
+
+#include <vector>
+
+#include "chess.hpp"
+#include "types.hpp"
+
+// Many positions laid out as a structure of arrays, each piece bitboard of
+// every position next to the same bitboard of the others, so the kernels
+// below run the shifts and masks of several positions per vector register
+// (four with AVX2). For throughput work like perft leaves or labelling
+// training data, the search keeps using Chess and MoveGenerator.
+class BoardBatch {
+   public:
+    // Positions per AVX2 register, the arrays are padded to a multiple of it
+    static constexpr size_t LANES = 4;
+
+    void add(const Chess&);
+    void clear();
+    size_t size() const { return count; }
+
+    // Squares attacked by color c in each position
+    void attacks(Color c, U64* out) const;
+
+    // Moves MoveGenerator::generatePseudoLegalMoves produces in each
+    // position, evasions only when in check, and how many of them are legal
+    void countMoves(U32* pseudoLegal, U32* legal) const;
+
+    // Whether the kernels run four positions per register on this CPU,
+    // true for an AVX2 build on a CPU with AVX2, otherwise they take one
+    // position at a time
+    static bool vectorized();
+
+   private:
+    size_t count = 0;
+    std::vector<U64> pieces[N_COLORS][N_PIECES];
+
+    // All ones when white is to move, so kernels can blend on it
+    std::vector<U64> whiteToMove;
+
+    // En passant square, and the king destinations castling rights allow
+    std::vector<U64> enPassant;
+    std::vector<U64> castling;
+
+    // The kernels over any lane type, and their AVX2 builds
+    template <typename Lanes>
+    void attacksWith(Color, U64*) const;
+    template <typename Lanes>
+    void countMovesWith(U32*, U32*) const;
+    void attacksAvx2(Color, U64*) const;
+    void countMovesAvx2(U32*, U32*) const;
+};
+
+#endif
@@ -3,8 +3,13 @@
 
 #include <array>
 #include <iostream>
+#include <type_traits>
 #include <vector>
 
+#ifdef USE_AVX2
+#include <immintrin.h>
+#endif
+
 #include "magics.hpp"
 #include "types.hpp"
 #include "defs.hpp"
@@ -189,6 +194,95 @@ inline U64 fillFiles(U64 bb) {
     // Fills both north and south for the given bitboard.
     return fillNorth(bb) | fillSouth(bb);
 }
+
+template <int s>
+constexpr U64 shift(U64 bb) {
+    // Shifts the bitboard s squares, north/east when positive.
+    if constexpr (s > 0)
+        return bb << s;
+    else
+        return bb >> -s;
+}
+
+template <typename T>
+constexpr T broadcast(U64 bb) {
+    // The bitboard in every lane of T, either a U64 or a type holding several
+    // bitboards with its own of(), shift<s>(), & and | (see BoardBatch).
+    if constexpr (std::is_same_v<T, U64>)
+        return bb;
+    else
+        return T::of(bb);
+}
+
+template <int s, typename T>
+inline T occludedFill(const T& gen, const std::type_identity_t<T>& empty) {
+    // Kogge-Stone fill of the generators in direction s (positive shifts
+    // north/east) through empty squares, then one more step onto the first
+    // blocker: the attacks of every slider in gen at once.
+    // https://www.chessprogramming.org/Kogge-Stone_Algorithm
+    constexpr U64 wrap = (s == 1 || s == 9 || s == -7)    ? ~FILE_MASK[FILE1]
+                         : (s == -1 || s == -9 || s == 7) ? ~FILE_MASK[FILE8]
+                                                          : ~0ull;
+    T pro = empty & broadcast<T>(wrap);
+    T fill = gen | (pro & shift<s>(gen));
+    pro = pro & shift<s>(pro);
+    fill = fill | (pro & shift<2 * s>(fill));
+    pro = pro & shift<2 * s>(pro);
+    fill = fill | (pro & shift<4 * s>(fill));
+    return shift<s>(fill) & broadcast<T>(wrap);
+}
+
+#ifdef USE_AVX2
+__attribute__((target("avx2")))
+#endif
+inline U64 slidingAttacks(U64 straight, U64 diagonal, U64 occupancy) {
+    // Union of the attacks of all straight and all diagonal sliders, without
+    // looking up each one. With AVX2 the 8 directions run as two registers of
+    // 4 lanes, shifting left (N, E, NE, NW) and right (S, W, SW, SE) by the
+    // same per lane amounts.
+#ifdef USE_AVX2
+    const __m256i shifts = _mm256_setr_epi64x(8, 1, 9, 7);
+    const __m256i shifts2 = _mm256_slli_epi64(shifts, 1);
+    const __m256i shifts4 = _mm256_slli_epi64(shifts, 2);
+    const U64 notA = ~FILE_MASK[FILE1], notH = ~FILE_MASK[FILE8];
+    const __m256i wrapUp = _mm256_setr_epi64x(-1, notA, notA, notH);
+    const __m256i wrapDown = _mm256_setr_epi64x(-1, notH, notH, notA);
+
+    __m256i gen = _mm256_setr_epi64x(straight, straight, diagonal, diagonal);
+    __m256i empty = _mm256_set1_epi64x(~occupancy);
+
+    __m256i up = gen, proUp = _mm256_and_si256(empty, wrapUp);
+    __m256i down = gen, proDown = _mm256_and_si256(empty, wrapDown);
+    up = _mm256_or_si256(up, _mm256_and_si256(proUp, _mm256_sllv_epi64(up, shifts)));
+    down = _mm256_or_si256(down, _mm256_and_si256(proDown, _mm256_srlv_epi64(down, shifts)));
+    proUp = _mm256_and_si256(proUp, _mm256_sllv_epi64(proUp, shifts));
+    proDown = _mm256_and_si256(proDown, _mm256_srlv_epi64(proDown, shifts));
+    up = _mm256_or_si256(up, _mm256_and_si256(proUp, _mm256_sllv_epi64(up, shifts2)));
+    down = _mm256_or_si256(down, _mm256_and_si256(proDown, _mm256_srlv_epi64(down, shifts2)));
+    proUp = _mm256_and_si256(proUp, _mm256_sllv_epi64(proUp, shifts2));
+    proDown = _mm256_and_si256(proDown, _mm256_srlv_epi64(proDown, shifts2));
+    up = _mm256_or_si256(up, _mm256_and_si256(proUp, _mm256_sllv_epi64(up, shifts4)));
+    down = _mm256_or_si256(down, _mm256_and_si256(proDown, _mm256_srlv_epi64(down, shifts4)));
+
+    __m256i attacks = _mm256_or_si256(_mm256_and_si256(_mm256_sllv_epi64(up, shifts), wrapUp),
+                                      _mm256_and_si256(_mm256_srlv_epi64(down, shifts), wrapDown));
+    __m128i half =
+        _mm_or_si128(_mm256_castsi256_si128(attacks), _mm256_extracti128_si256(attacks, 1));
+    return _mm_cvtsi128_si64(_mm_or_si128(half, _mm_unpackhi_epi64(half, half)));
+#else
+    U64 empty = ~occupancy;
+    return occludedFill<8>(straight, empty) | occludedFill<-8>(straight, empty) |
+           occludedFill<1>(straight, empty) | occludedFill<-1>(straight, empty) |
+           occludedFill<9>(diagonal, empty) | occludedFill<7>(diagonal, empty) |
+           occludedFill<-7>(diagonal, empty) | occludedFill<-9>(diagonal, empty);
+#endif
+}
+
+template <PieceType p>
+inline U64 attacksBySliders(U64 sliders, U64 occupancy) {
+    // Setwise attacks of all given rooks, bishops or queens.
+    return slidingAttacks(p == BISHOP ? 0 : sliders, p == ROOK ? 0 : sliders, occupancy);
+}
 inline U64 shiftSouth(U64 bb) {
     // Shifts the bitboard south (down) by 8 squares.
     return bb >> 8;
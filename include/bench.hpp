@@ -0,0 +1,33 @@
+#ifndef LATRUNCULI_BENCH_H
+#define LATRUNCULI_BENCH_H
+
+#include <array>
+#include <iostream>
+
+#include "types.hpp"
+
+// Fixed depth search of a fixed set of positions. The total node count is a
+// signature of the search: any change that alters it changes the engine's
+// play, while a pure speedup leaves it alone and only moves nps.
+namespace Bench {
+
+constexpr int DEPTH = 5;
+
+// Total nodes at DEPTH. A change that is meant to alter the search updates
+// this and states the new signature in its commit message.
+constexpr U64 SIGNATURE = 5504815;
+
+extern const std::array<const char*, 50> POSITIONS;
+
+struct Report {
+    U64 nodes = 0;
+    double seconds = 0;
+
+    U64 nps() const { return U64(nodes / (seconds > 0 ? seconds : 1e-9)); }
+};
+
+Report run(int depth, std::ostream&);
+
+}  // namespace Bench
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef LATRUNCULI_BITBASE_H
+#define LATRUNCULI_BITBASE_H
+
+#include "types.hpp"
+
+namespace Bitbases {
+
+// King and pawn vs king win/draw bitbase, one bit per position with the
+// pawn on files a-d: 2 sides to move * 24 pawn squares * 64 * 64 kings
+const unsigned KPK_SIZE = 2 * 24 * 64 * 64;
+
+void init();
+
+// Probe with white as the side with the pawn, any pawn file
+bool probeKPK(Square whiteKing, Square pawn, Square blackKing, Color stm);
+
+}  // namespace Bitbases
+
+#endif
@@ -16,6 +16,7 @@ struct Board {
     Piece squares[N_SQUARES] = {NO_PIECE};
     Square kingSq[N_COLORS] = {E1, E8};
     U8 pieceCount[N_COLORS][N_PIECES] = {0};
+    U64 materialKey = 0;
 
     Board() = default;
     explicit Board(const std::string&);
@@ -48,6 +49,7 @@ struct Board {
     bool isBitboardAttacked(U64, Color) const;
 
     // eval helpers
+    static constexpr U64 materialKeyBit(Color, PieceType);
     int nonPawnMaterial(Color) const;
     bool oppositeBishopsEndGame() const;
     U64 passedPawns(Color) const;
@@ -56,7 +58,7 @@ struct Board {
 inline Board::Board(const std::string& fen) {
     FenParser parser(fen);
 
-    auto piece_placement = parser.getPiecePlacement();
+    auto& piece_placement = parser.getPiecePlacement();
     for (auto piece = piece_placement.begin(); piece != piece_placement.end(); ++piece) {
         addPiece(piece->square, piece->color, piece->role);
 
@@ -72,6 +74,7 @@ inline void Board::addPiece(const Square sq, const Color c, const PieceType p) {
     pieces[c][p] ^= BB::set(sq);
     squares[sq] = Defs::makePiece(c, p);
     pieceCount[c][p]++;
+    materialKey += materialKeyBit(c, p);
 }
 
 inline void Board::removePiece(const Square sq, const Color c, const PieceType p) {
@@ -80,6 +83,7 @@ inline void Board::removePiece(const Square sq, const Color c, const PieceType p
     pieces[c][p] ^= BB::set(sq);
     // squares[sq] = NO_PIECE;
     pieceCount[c][p]--;
+    materialKey -= materialKeyBit(c, p);
 }
 
 inline void Board::movePiece(const Square from, const Square to, const Color c, const PieceType p) {
@@ -206,6 +210,12 @@ inline bool Board::isBitboardAttacked(U64 bitboard, Color c) const {
     return false;
 }
 
+inline constexpr U64 Board::materialKeyBit(Color c, PieceType p) {
+    // The material key packs every non-king piece count into its own
+    // 4 bit field, so equal keys always mean equal material
+    return p == KING ? 0 : 1ull << (4 * (8 * c + p));
+}
+
 inline int Board::nonPawnMaterial(Color c) const {
     return (count<KNIGHT>(c) * Eval::mgPieceValue(KNIGHT) +
             count<BISHOP>(c) * Eval::mgPieceValue(BISHOP) +
@@ -0,0 +1,63 @@
+#ifndef LATRUNCULI_BOOK_H
+#define LATRUNCULI_BOOK_H
+
+#include <istream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "move.hpp"
+#include "types.hpp"
+
+class Chess;
+
+// Polyglot opening books
+// http://hgm.nubati.net/book_format.html
+namespace Book {
+
+// One 16 byte big endian record, sorted by key in the file
+struct Entry {
+    U64 key;
+    U16 move;
+    U16 weight;
+    U32 learn;
+};
+
+constexpr size_t ENTRY_SIZE = 16;
+
+// A book file memory mapped read only, looked up by binary search
+class Reader {
+   private:
+    const U8* data = nullptr;
+    size_t mapped = 0;  // length of the mapping, the whole file
+    size_t bytes = 0;   // whole entries within it
+    std::mt19937 rng{std::random_device{}()};
+
+    Entry entryAt(size_t) const;
+
+   public:
+    Reader() = default;
+    ~Reader();
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    bool open(const std::string&);
+    void close();
+    bool isOpen() const { return data != nullptr; }
+    size_t size() const { return bytes / ENTRY_SIZE; }
+
+    std::vector<Entry> probe(U64) const;
+    Move pick(Chess&, bool best = false);
+};
+
+U16 encodeMove(Move);
+Move decodeMove(Chess&, U16);
+Move parseSAN(Chess&, const std::string&);
+
+std::vector<Entry> fromPGN(std::istream&, int maxPly);
+bool write(const std::string&, const std::vector<Entry>&);
+
+}  // namespace Book
+
+#endif
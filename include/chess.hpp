@@ -2,12 +2,13 @@
 #define LATRUNCULI_CHESS_H
 
 #include <string>
-#include <tuple>
+#include <string_view>
 #include <vector>
 
 #include "board.hpp"
 #include "constants.hpp"
 #include "eval.hpp"
+#include "material.hpp"
 #include "state.hpp"
 #include "zobrist.hpp"
 
@@ -18,21 +19,33 @@ class Chess {
     Color turn = WHITE;
     U32 ply = 0;
     U32 moveCounter = 0;
-    int material[2] = {0, 0};
-    int pieceSquares[2] = {0, 0};
+    Score psq = SCORE_ZERO;
 
    public:
     explicit Chess(const std::string&);
 
+    // Longest FEN toFEN writes into a buffer, at most 10 digit move numbers
+    static constexpr size_t MAX_FEN = 96;
+
+    // fen
+    bool setFromFEN(std::string_view);
+    char* toFEN(char*) const;
+
     // eval
     template <bool>
     int eval() const;
 
     // eval helpers
     template <Phase>
-    int phaseEval(int, int) const;
-    std::tuple<int, int> pawnsEval() const;
-    std::tuple<int, int> piecesEval() const;
+    int phaseEval(Score) const;
+    void initEvalInfo(Eval::EvalInfo&) const;
+    Score pawnsEval() const;
+    Score piecesEval(Eval::EvalInfo&) const;
+    template <Color, PieceType>
+    Score piecesEval(Eval::EvalInfo&) const;
+    Score kingEval(const Eval::EvalInfo&) const;
+    template <Color>
+    Score kingEval(const Eval::EvalInfo&) const;
     int scaleFactor() const;
 
     // make move / mutators
@@ -57,20 +70,30 @@ class Chess {
 
     // accessors
     U64 getKey() const { return state.at(ply).zkey; }
+    U64 getMaterialKey() const { return board.materialKey; }
+    Piece getPiece(Square sq) const { return board.getPiece(sq); }
     U64 getCheckingPieces() const { return state.at(ply).checkingPieces; }
     Square getEnPassant() const { return state.at(ply).enPassantSq; }
     U8 getHmClock() const { return state.at(ply).hmClock; }
+    Color getTurn() const { return turn; }
+    PieceType getCaptured() const { return state.at(ply).captured; }
+    int nonPawnMaterial(Color c) const { return board.nonPawnMaterial(c); }
     bool isCheck() const { return getCheckingPieces(); }
     bool isDoubleCheck() const { return BB::moreThanOneSet(getCheckingPieces()); }
+    Score psqScore() const { return psq; }
     template <Phase ph>
-    int materialScore() const { return material[ph]; }
+    int materialScore() const;
     template <Phase ph>
-    int pieceSqScore() const { return pieceSquares[ph]; }
+    int pieceSqScore() const { return scoreValue<ph>(psq) - materialScore<ph>(); }
 
     // other helpers
     U64 calculateKey() const;
+    U64 calculatePolyglotKey() const;
     bool isPseudoLegalMoveLegal(Move) const;
     bool isCheckingMove(Move) const;
+    bool isRepetition(int) const;
+    bool isDraw(int) const;
+    bool hasUpcomingRepetition(int) const;
 
     // string helpers
     std::string toFEN() const;
@@ -78,15 +101,13 @@ class Chess {
     friend std::ostream& operator<<(std::ostream& os, const Chess& chess);
 
     friend class MoveGenerator;
+    friend class BoardBatch;
 };
 
 template <bool forward>
 inline void Chess::addPiece(Square sq, Color c, PieceType pt) {
     board.addPiece(sq, c, pt);
-    material[MIDGAME] += Eval::pieceValue(MIDGAME, c, pt);
-    material[ENDGAME] += Eval::pieceValue(ENDGAME, c, pt);
-    pieceSquares[MIDGAME] += Eval::pieceSqBonus(MIDGAME, c, pt, sq);
-    pieceSquares[ENDGAME] += Eval::pieceSqBonus(ENDGAME, c, pt, sq);
+    psq += Eval::psq[Defs::makePiece(c, pt)][sq];
 
     if (forward) {
         state.at(ply).zkey ^= Zobrist::psq[c][pt][sq];
@@ -96,10 +117,7 @@ inline void Chess::addPiece(Square sq, Color c, PieceType pt) {
 template <bool forward>
 inline void Chess::removePiece(Square sq, Color c, PieceType pt) {
     board.removePiece(sq, c, pt);
-    material[MIDGAME] -= Eval::pieceValue(MIDGAME, c, pt);
-    material[ENDGAME] -= Eval::pieceValue(ENDGAME, c, pt);
-    pieceSquares[MIDGAME] -= Eval::pieceSqBonus(MIDGAME, c, pt, sq);
-    pieceSquares[ENDGAME] -= Eval::pieceSqBonus(ENDGAME, c, pt, sq);
+    psq -= Eval::psq[Defs::makePiece(c, pt)][sq];
 
     if (forward) {
         state.at(ply).zkey ^= Zobrist::psq[c][pt][sq];
@@ -109,10 +127,8 @@ inline void Chess::removePiece(Square sq, Color c, PieceType pt) {
 template <bool forward>
 inline void Chess::movePiece(Square from, Square to, Color c, PieceType pt) {
     board.movePiece(from, to, c, pt);
-    pieceSquares[MIDGAME] +=
-        Eval::pieceSqBonus(MIDGAME, c, pt, to) - Eval::pieceSqBonus(MIDGAME, c, pt, from);
-    pieceSquares[ENDGAME] +=
-        Eval::pieceSqBonus(ENDGAME, c, pt, to) - Eval::pieceSqBonus(ENDGAME, c, pt, from);
+    Piece piece = Defs::makePiece(c, pt);
+    psq += Eval::psq[piece][to] - Eval::psq[piece][from];
 
     if (forward) {
         state.at(ply).zkey ^= Zobrist::psq[c][pt][from] ^ Zobrist::psq[c][pt][to];
@@ -193,17 +209,51 @@ inline U64 Chess::calculateKey() const {
     return zkey;
 }
 
+inline U64 Chess::calculatePolyglotKey() const {
+    // Opening book key, piece kinds alternate black/white from pawn to king
+    U64 pkey = 0x0;
+
+    for (auto sq = A1; sq != INVALID; sq++) {
+        auto piece = board.getPiece(sq);
+        if (piece != NO_PIECE) {
+            int kind = 2 * (Defs::getPieceType(piece) - PAWN) + Defs::getPieceColor(piece);
+            pkey ^= Zobrist::polyglot[64 * kind + sq];
+        }
+    }
+
+    if (state.at(ply).canCastleOO(WHITE)) pkey ^= Zobrist::polyglot[Zobrist::POLYGLOT_CASTLE];
+    if (state.at(ply).canCastleOOO(WHITE)) pkey ^= Zobrist::polyglot[Zobrist::POLYGLOT_CASTLE + 1];
+    if (state.at(ply).canCastleOO(BLACK)) pkey ^= Zobrist::polyglot[Zobrist::POLYGLOT_CASTLE + 2];
+    if (state.at(ply).canCastleOOO(BLACK)) pkey ^= Zobrist::polyglot[Zobrist::POLYGLOT_CASTLE + 3];
+
+    // En passant only counts when a pawn is actually able to capture
+    auto sq = getEnPassant();
+    if (sq != INVALID && (board.getPieces<PAWN>(turn) & BB::attacksByPawns(BB::set(sq), ~turn))) {
+        pkey ^= Zobrist::polyglot[Zobrist::POLYGLOT_EP + Defs::fileFromSq(sq)];
+    }
+
+    if (turn == WHITE) pkey ^= Zobrist::polyglot[Zobrist::POLYGLOT_TURN];
+
+    return pkey;
+}
+
 template <Phase ph>
-inline int Chess::phaseEval(int pawnScore, int pieceScore) const {
+inline int Chess::materialScore() const {
+    // Material is folded into the psq score, recount it from the piece counts
     int score = 0;
+    for (int pt = PAWN; pt < KING; ++pt) {
+        score += Eval::pieceValue(ph, WHITE, PieceType(pt)) * board.pieceCount[WHITE][pt];
+        score += Eval::pieceValue(ph, BLACK, PieceType(pt)) * board.pieceCount[BLACK][pt];
+    }
+    return score;
+}
 
-    score += materialScore<ph>();
-    score += pieceSqScore<ph>();
-    score += pawnScore;
-    score += pieceScore;
+template <Phase ph>
+inline int Chess::phaseEval(Score terms) const {
+    int score = scoreValue<ph>(psq + terms);
 
     if constexpr (ph == ENDGAME) {
-        score *= (scaleFactor() / 64);
+        score = score * scaleFactor() / 64;
     }
 
     return score;
@@ -0,0 +1,38 @@
+#ifndef LATRUNCULI_ENDGAME_H
+#define LATRUNCULI_ENDGAME_H
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "board.hpp"
+#include "types.hpp"
+
+namespace Endgame {
+
+const int KNOWN_WIN = 10000;
+
+// Specialized evaluators for endgames recognized by their material key.
+// Each takes the side with the extra material and the side to move, and
+// scores from white's point of view.
+using EvalFn = int (*)(const Board&, Color, Color);
+
+int KXK(const Board&, Color, Color);
+int KBNK(const Board&, Color, Color);
+int KPK(const Board&, Color, Color);
+
+inline int pushToEdge(Square sq) {
+    int rankDist = std::min<int>(Defs::rankFromSq(sq), RANK8 - Defs::rankFromSq(sq));
+    int fileDist = std::min<int>(Defs::fileFromSq(sq), FILE8 - Defs::fileFromSq(sq));
+    return 90 - (7 * fileDist * fileDist / 2 + 7 * rankDist * rankDist / 2);
+}
+
+inline int pushClose(Square sq1, Square sq2) { return 140 - 20 * BB::DISTANCE[sq1][sq2]; }
+
+inline int pushToCorner(Square sq) {
+    // Largest on a1 and h8, zero along the a8-h1 diagonal
+    return std::abs(7 - Defs::rankFromSq(sq) - Defs::fileFromSq(sq));
+}
+
+}  // namespace Endgame
+
+#endif
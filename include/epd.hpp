@@ -0,0 +1,45 @@
+#ifndef LATRUNCULI_EPD_H
+#define LATRUNCULI_EPD_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "move.hpp"
+#include "search.hpp"
+
+// Extended Position Description test suites
+// https://www.chessprogramming.org/Extended_Position_Description
+namespace EPD {
+
+struct Position {
+    std::string fen;
+    std::string id;
+    std::vector<std::string> bestMoves;
+    std::vector<std::string> avoidMoves;
+};
+
+struct Result {
+    Move move;
+    int score = 0;
+    U64 nodes = 0;
+    bool solved = false;
+    bool skipped = false;
+};
+
+struct Report {
+    std::vector<Result> results;
+    size_t solved = 0;
+    size_t skipped = 0;
+    U64 nodes = 0;
+    double seconds = 0;
+};
+
+bool parse(const std::string&, Position&);
+std::vector<Position> load(std::istream&);
+Result solve(const Position&, Chess&, Search&, const SearchLimits&);
+Report run(const std::vector<Position>&, const SearchLimits&, size_t threads);
+
+}  // namespace EPD
+
+#endif
@@ -1,9 +1,11 @@
 #ifndef LATRUNCULI_EVAL_H
 #define LATRUNCULI_EVAL_H
 
+#include <algorithm>
 #include <array>
 
 #include "bb.hpp"
+#include "evalparams.hpp"
 #include "types.hpp"
 
 namespace Eval {
@@ -12,159 +14,59 @@ const int PHASE_LIMIT = 128;
 const int MG_LIMIT = 15258;
 const int EG_LIMIT = 3915;
 const int TEMPO_BONUS = 25;
-const int ISO_PAWN_PENALTY[N_PHASES] = {-5, -15};
-const int BACKWARD_PAWN_PENALTY[N_PHASES] = {-9, -25};
-const int DOUBLED_PAWN_PENALTY[N_PHASES] = {-11, -56};
 
 const U64 WHITESQUARES = 0x55AA55AA55AA55AA;
 const U64 BLACKSQUARES = 0xAA55AA55AA55AA55;
 const U64 WHITEHOLES = 0x0000003CFFFF0000;
 const U64 BLACKHOLES = 0x0000FFFF3C000000;
 
-// clang-format off
-const int pieceValueArray[N_PHASES][N_COLORS][N_PIECES] = {{
-    // midgame (black, white)
-    {0, -124, -781, -825, -1276, -2538, 0},
-    {0, 124, 781, 825, 1276, 2538, 0}       
-}, {
-    // endgame (black, white)
-    {0, -206, -854, -915, -1380, -2682, 0},
-    {0, 206, 854, 915, 1380, 2682, 0}
-}};
-
-constexpr ScoreArray pawnBonusMg = {{
-     0,   0,   0,   0,   0,   0,   0,   0,
-     3,   3,  10,  19,  16,  19,   7,  -5,
-    -9, -15,  11,  15,  32,  22,   5, -22,
-    -4, -23,   6,  20,  40,  17,   4,  -8,
-    13,   0, -13,   1,  11,  -2, -13,   5,
-     5, -12,  -7,  22,  -8,  -5, -15,  -8,
-    -7,   7,  -3, -13,   5, -16,  10,  -8,
-     0,   0,   0,   0,   0,   0,   0,   0
-}};
-
-constexpr ScoreArray pawnBonusEg = {{
-     0,   0,   0,   0,   0,   0,   0,   0,
-   -10,  -6,  10,   0,  14,   7,  -5, -19,
-   -10, -10, -10,   4,   4,   3,  -6,  -4,
-     6,  -2,  -8,  -4, -13, -12, -10,  -9,
-    10,   5,   4,  -5,  -5,  -5,  14,   9,
-    28,  20,  21,  28,  30,   7,   6,  13,
-     0, -11,  12,  21,  25,  19,   4,   7,
-     0,   0,   0,   0,   0,   0,   0,   0
-}};
-
-constexpr ScoreArray knightBonusMg = {{
-   -175, -92, -74, -73, -73, -74, -92, -175,
-    -77, -41, -27, -15, -15, -27, -41,  -77,
-    -61, -17,   6,  12,  12,   6, -17,  -61,
-    -35,   8,  40,  49,  49,  40,   8,  -35,
-    -34,  13,  44,  51,  51,  44,  13,  -34,
-     -9,  22,  58,  53,  53,  58,  22,   -9,
-    -67, -27,   4,  37,  37,   4, -27,  -67,
-   -201, -83, -56, -26, -26, -56, -83, -201
-}};
-
-constexpr ScoreArray knightBonusEg = {{
-    -96, -65, -49, -21, -21, -49, -65, -96,
-    -67, -54, -18,   8,   8, -18, -54, -67,
-    -40, -27,  -8,  29,  29,  -8, -27, -40,
-    -35,  -2,  13,  28,  28,  13,  -2, -35,
-    -45, -16,   9,  39,  39,   9, -16, -45,
-    -51, -44, -16,  17,  17, -16, -44, -51,
-    -69, -50, -51,  12,  12, -51, -50, -69,
-   -100, -88, -56, -17, -17, -56, -88, -100
-}};
-
-constexpr ScoreArray bishopBonusMg = {{
-    -53,  -5,  -8, -23, -23,  -8,  -5, -53,
-    -15,   8,  19,   4,   4,  19,   8, -15,
-     -7,  21,  -5,  17,  17,  -5,  21,  -7,
-     -5,  11,  25,  39,  39,  25,  11,  -5,
-    -12,  29,  22,  31,  31,  22,  29, -12,
-    -16,   6,   1,  11,  11,   1,   6, -16,
-    -17, -14,   5,   0,   0,   5, -14, -17,
-    -48,   1, -14, -23, -23, -14,   1, -48
-}};
-
-constexpr ScoreArray bishopBonusEg = {{
-    -57, -30, -37, -12, -12, -37, -30, -57,
-    -37, -13, -17,   1,   1, -17, -13, -37,
-    -16,  -1,  -2,  10,  10,  -2,  -1, -16,
-    -20,  -6,   0,  17,  17,   0,  -6, -20,
-    -17,  -1, -14,  15,  15, -14,  -1, -17,
-    -30,   6,   4,   6,   6,   4,   6, -30,
-    -31, -20,  -1,   1,   1,  -1, -20, -31,
-    -46, -42, -37, -24, -24, -37, -42, -46
-}};
-
-constexpr ScoreArray rookBonusMg = {{
-    -31, -20, -14,  -5,  -5, -14, -20, -31,
-    -21, -13,  -8,   6,   6,  -8, -13, -21,
-    -25, -11,  -1,   3,   3,  -1, -11, -25,
-    -13,  -5,  -4,  -6,  -6,  -4,  -5, -13,
-    -27, -15,  -4,   3,   3,  -4, -15, -27,
-    -22,  -2,   6,  12,  12,   6,  -2, -22,
-     -2,  12,  16,  18,  18,  16,  12,  -2,
-    -17, -19,  -1,   9,   9,  -1, -19, -17
-}};
-
-constexpr ScoreArray rookBonusEg = {{
-     -9, -13, -10,  -9,  -9, -10, -13,  -9,
-    -12,  -9,  -1,  -2,  -2,  -1,  -9, -12,
-      6,  -8,  -2,  -6,  -6,  -2,  -8,   6,
-     -6,   1,  -9,   7,   7,  -9,   1,  -6,
-     -5,   8,   7,  -6,  -6,   7,   8,  -5,
-      6,   1,  -7,  10,  10,  -7,   1,   6,
-      4,   5,  20,  -5,  -5,  20,   5,   4,
-     18,   0,  19,  13,  13,  19,   0,  18
-}};
-
-constexpr ScoreArray queenBonusMg = {{
-      3,  -5,  -5,   4,   4,  -5,  -5,   3,
-     -3,   5,   8,  12,  12,   8,   5,  -3,
-     -3,   6,  13,   7,   7,  13,   6,  -3,
-      4,   5,   9,   8,   8,   9,   5,   4,
-      0,  14,  12,   5,   5,  12,  14,   0,
-     -4,  10,   6,   8,   8,   6,  10,  -4,
-     -5,   6,  10,   8,   8,  10,   6,  -5,
-     -2,  -2,   1,  -2,  -2,   1,  -2,  -2
-}};
-
-constexpr ScoreArray queenBonusEg = {{
-    -69, -57, -47, -26, -26, -47, -57, -69,
-    -55, -31, -22,  -4,  -4, -22, -31, -55,
-    -39, -18,  -9,   3,   3,  -9, -18, -39,
-    -23,  -3,  13,  24,  24,  13,  -3, -23,
-    -29,  -6,   9,  21,  21,   9,  -6, -29,
-    -38, -18, -12,   1,   1, -12, -18, -38,
-    -50, -27, -24,  -8,  -8, -24, -27, -50,
-    -75, -52, -43, -36, -36, -43, -52, -75
-}};
+const Score KNIGHT_OUTPOST_BONUS = makeScore(30, 21);
+const Score BISHOP_OUTPOST_BONUS = makeScore(15, 10);
+const Score REACHABLE_OUTPOST_BONUS = makeScore(16, 5);
+const Score ROOK_OPEN_FILE_BONUS = makeScore(47, 25);
+const Score ROOK_SEMIOPEN_FILE_BONUS = makeScore(21, 4);
+const Score KING_SHIELD_BONUS = makeScore(12, 0);
+const int KING_ATTACK_WEIGHT[N_PIECES] = {0, 0, 81, 52, 44, 10, 0};
+const int KING_ATTACKS_FACTOR = 69;
+const int KING_WEAK_SQUARES_FACTOR = 185;
+const int KING_NO_QUEEN_DISCOUNT = 873;
+const int KING_DANGER_OFFSET = 37;
+const int KING_DANGER_THRESHOLD = 100;
+
+// Attack maps and king-zone attack counts, filled once per eval by a single
+// attack generation pass over every piece and shared by the eval terms.
+struct EvalInfo {
+    U64 attackedBy[N_COLORS][N_PIECES] = {};
+    U64 attackedBy2[N_COLORS] = {};
+    U64 mobilityArea[N_COLORS] = {};
+    U64 outposts[N_COLORS] = {};
+    U64 kingZone[N_COLORS] = {};
+    int kingAttackersCount[N_COLORS] = {};
+    int kingAttackersWeight[N_COLORS] = {};
+    int kingAttacksCount[N_COLORS] = {};
+};
 
-constexpr ScoreArray kingBonusMg = {{
-    271, 327, 271, 198, 198, 271, 327, 271,
-    278, 303, 234, 179, 179, 234, 303, 278,
-    195, 258, 169, 120, 120, 169, 258, 195,
-    164, 190, 138,  98,  98, 138, 190, 164,
-    154, 179, 105,  70,  70, 105, 179, 154,
-    123, 145,  81,  31,  31,  81, 145, 123,
-     88, 120,  65,  33,  33,  65, 120,  88,
-     59,  89,  45,  -1,  -1,  45,  89,  59
-}};
-
-constexpr ScoreArray kingBonusEg = {{
-      1,  45,  85,  76,  76,  85,  45,   1,
-     53, 100, 133, 135, 135, 133, 100,  53,
-     88, 130, 169, 175, 175, 169, 130,  88,
-    103, 156, 172, 172, 172, 172, 156, 103,
-     96, 166, 199, 199, 199, 199, 166,  96,
-     92, 172, 184, 191, 191, 184, 172,  92,
-     47, 121, 116, 131, 131, 116, 121,  47,
-     11,  59,  73,  78,  78,  73,  59,  11
-}};
+// clang-format off
+#define S(mg, eg) makeScore(mg, eg)
+const Score mobilityBonus[N_PIECES][28] = {
+    // indexed by piece type, then by the number of reachable squares
+    {}, {},
+    {S(-62, -81), S(-53, -56), S(-12, -30), S(-4, -14), S(3, 8), S(13, 15), S(22, 23), S(28, 27),
+     S(33, 33)},
+    {S(-48, -59), S(-20, -23), S(16, -3), S(26, 13), S(38, 24), S(51, 42), S(55, 54), S(63, 57),
+     S(63, 65), S(68, 73), S(81, 78), S(81, 86), S(91, 88), S(98, 97)},
+    {S(-58, -76), S(-27, -18), S(-15, 28), S(-10, 55), S(-5, 69), S(-2, 82), S(9, 112),
+     S(16, 118), S(30, 132), S(29, 142), S(32, 155), S(38, 165), S(46, 166), S(48, 169), S(58, 171)},
+    {S(-39, -36), S(-21, -15), S(3, 8), S(3, 18), S(14, 34), S(22, 54), S(28, 61), S(41, 73),
+     S(43, 79), S(48, 92), S(56, 94), S(60, 104), S(60, 113), S(66, 120), S(67, 123), S(70, 126),
+     S(71, 133), S(73, 136), S(79, 140), S(88, 143), S(88, 148), S(99, 166), S(102, 170),
+     S(102, 175), S(106, 184), S(109, 191), S(113, 206), S(116, 212)},
+};
+#undef S
+// clang-format on
 
-const Square squareMap[N_COLORS][N_SQUARES] = {{
+// clang-format off
+constexpr Square squareMap[N_COLORS][N_SQUARES] = {{
     H8, G8, F8, E8, D8, C8, B8, A8,
     H7, G7, F7, E7, D7, C7, B7, A7,
     H6, G6, F6, E6, D6, C6, B6, A6,
@@ -185,25 +87,51 @@ const Square squareMap[N_COLORS][N_SQUARES] = {{
 }};
 // clang-format on
 
-inline int pieceValue(Phase ph, Color c, PieceType pt) { return pieceValueArray[ph][c][pt]; }
-inline int mgPieceValue(PieceType pt) { return pieceValueArray[MIDGAME][WHITE][pt]; }
-inline int egPieceValue(PieceType pt) { return pieceValueArray[ENDGAME][WHITE][pt]; }
-
-const std::array<ScoreArray, N_PHASES> pawnBonus = {{pawnBonusMg, pawnBonusEg}};
-const std::array<ScoreArray, N_PHASES> knightBonus = {{knightBonusMg, knightBonusEg}};
-const std::array<ScoreArray, N_PHASES> bishopBonus = {{bishopBonusMg, bishopBonusEg}};
-const std::array<ScoreArray, N_PHASES> rookBonus = {{rookBonusMg, rookBonusEg}};
-const std::array<ScoreArray, N_PHASES> queenBonus = {{queenBonusMg, queenBonusEg}};
-const std::array<ScoreArray, N_PHASES> kingBonus = {{kingBonusMg, kingBonusEg}};
-const std::array<std::array<ScoreArray, N_PHASES>, 6> pieceBonus = {
+inline constexpr int pieceValue(Phase ph, Color c, PieceType pt) {
+    return pieceValueArray[ph][c][pt];
+}
+inline constexpr int mgPieceValue(PieceType pt) { return pieceValueArray[MIDGAME][WHITE][pt]; }
+inline constexpr int egPieceValue(PieceType pt) { return pieceValueArray[ENDGAME][WHITE][pt]; }
+
+constexpr std::array<ScoreArray, N_PHASES> pawnBonus = {{pawnBonusMg, pawnBonusEg}};
+constexpr std::array<ScoreArray, N_PHASES> knightBonus = {{knightBonusMg, knightBonusEg}};
+constexpr std::array<ScoreArray, N_PHASES> bishopBonus = {{bishopBonusMg, bishopBonusEg}};
+constexpr std::array<ScoreArray, N_PHASES> rookBonus = {{rookBonusMg, rookBonusEg}};
+constexpr std::array<ScoreArray, N_PHASES> queenBonus = {{queenBonusMg, queenBonusEg}};
+constexpr std::array<ScoreArray, N_PHASES> kingBonus = {{kingBonusMg, kingBonusEg}};
+constexpr std::array<std::array<ScoreArray, N_PHASES>, 6> pieceBonus = {
     {pawnBonus, knightBonus, bishopBonus, rookBonus, queenBonus, kingBonus}};
 
-inline int pieceSqBonus(Phase ph, Color c, PieceType pt, Square sq) {
+inline constexpr int pieceSqBonus(Phase ph, Color c, PieceType pt, Square sq) {
     // Get the piece square value for color c
     int score = pieceBonus[pt - 1][ph][squareMap[c][sq]];
     return (2 * c * score) - score;
 }
 
+using PsqTable = std::array<std::array<Score, N_SQUARES>, 16>;
+
+inline constexpr PsqTable makePsqTable() {
+    PsqTable table{};
+    for (Color c : {WHITE, BLACK}) {
+        for (int pt = PAWN; pt < N_PIECES; ++pt) {
+            Piece piece = Defs::makePiece(c, PieceType(pt));
+
+            for (int sq = A1; sq < N_SQUARES; ++sq) {
+                int mg = pieceValue(MIDGAME, c, PieceType(pt)) +
+                         pieceSqBonus(MIDGAME, c, PieceType(pt), Square(sq));
+                int eg = pieceValue(ENDGAME, c, PieceType(pt)) +
+                         pieceSqBonus(ENDGAME, c, PieceType(pt), Square(sq));
+                table[piece][sq] = makeScore(mg, eg);
+            }
+        }
+    }
+    return table;
+}
+
+// Material plus piece square score of each piece on each square, indexed by
+// [piece][square] with mirroring and the sign for black already applied
+constexpr PsqTable psq = makePsqTable();
+
 inline int tempoBonus(Color c) { return c == WHITE ? TEMPO_BONUS : -TEMPO_BONUS; }
 
 inline int taperScore(int mgScore, int egScore, int phase) {
@@ -241,56 +169,22 @@ inline bool oppositeBishops(U64 wBishops, U64 bBishops) {
             ((wBishops & Eval::BLACKSQUARES) && (bBishops & Eval::WHITESQUARES)));
 }
 
-}  // namespace Eval
-
-// int calculateMobilityScore(const int, const int) const;
-// template <PieceType>
-// int calculateMobilityScore(const int, const int) const;
-// template <PieceType p>
-// int calculateMobility(U64 bitboard, U64 targets, U64 occ) const;
-
-// int Board::calculateMobilityScore(const int opPhase, const int egPhase) const
-// {
-//     int score = 0;
-//     score += calculateMobilityScore<KNIGHT>(opPhase, egPhase);
-//     score += calculateMobilityScore<BISHOP>(opPhase, egPhase);
-//     score += calculateMobilityScore<ROOK  >(opPhase, egPhase);
-//     score += calculateMobilityScore<QUEEN >(opPhase, egPhase);
-//     return score;
-// }
-
-// template<PieceType p>
-// int Board::calculateMobilityScore(const int opPhase, const int egPhase) const
-// {
-//     int mobilityScore = 0;
-//     U64 occ = occupancy();
-
-//     int whitemoves = calculateMobility<p>(getPieces<p>(WHITE),
-//                                           ~getPieces<ALL_PIECE_TYPES>(WHITE), occ);
-//     mobilityScore += whitemoves * (opPhase * Eval::MobilityScaling[MIDGAME][p]
-//                                  + egPhase * Eval::MobilityScaling[ENDGAME][p]);
-
-//     int blackmoves = calculateMobility<p>(getPieces<p>(BLACK),
-//                                           ~getPieces<ALL_PIECE_TYPES>(BLACK), occ);
-//     mobilityScore -= blackmoves * (opPhase * Eval::MobilityScaling[MIDGAME][p]
-//                                  + egPhase * Eval::MobilityScaling[ENDGAME][p]);
-//     return mobilityScore;
-// }
-
-// template <PieceType p>
-// int Board::calculateMobility(U64 bitboard, U64 targets, U64 occ) const {
-//     int nmoves = 0;
-
-//     while (bitboard) {
-//         // Pop lsb bit and clear it from the bitboard
-//         Square from = BB::lsb(bitboard);
-//         bitboard &= BB::clear(from);
+template <Color color, Color enemy>
+inline U64 outposts(U64 pawns, U64 enemyPawns) {
+    // enemy half squares which can't be attacked by enemy pawns, supported by a pawn
+    U64 holes = (color == WHITE) ? Eval::BLACKHOLES : Eval::WHITEHOLES;
+    return holes & ~BB::getFrontAttackSpan<enemy>(enemyPawns) & BB::attacksByPawns<color>(pawns);
+}
 
-//         U64 mobility = BB::movesByPiece<p>(from, occ) & targets;
-//         nmoves += BB::bitCount(mobility);
-//     }
+inline int kingDanger(const EvalInfo& info, Color c, U64 weak, bool enemyQueen) {
+    // danger to the king of color c, from the enemy's king zone attacks
+    Color enemy = ~c;
+    return info.kingAttackersCount[enemy] * info.kingAttackersWeight[enemy] +
+           KING_ATTACKS_FACTOR * info.kingAttacksCount[enemy] +
+           KING_WEAK_SQUARES_FACTOR * BB::bitCount(info.kingZone[c] & weak) -
+           KING_NO_QUEEN_DISCOUNT * !enemyQueen + KING_DANGER_OFFSET;
+}
 
-//     return nmoves;
-// }
+}  // namespace Eval
 
-#endif
\ No newline at end of file
+#endif
@@ -13,7 +13,7 @@ class FenParser {
     explicit FenParser(const std::string& fen);
     void parse();
 
-    std::vector<PieceSquare> getPiecePlacement() const;
+    const std::vector<PieceSquare>& getPiecePlacement() const;
     Color getActiveColor() const;
     CastleRights getCastlingRights() const;
     Square getEnPassantTarget() const;
@@ -0,0 +1,122 @@
+#ifndef LATRUNCULI_MAGICNUMS_H
+#define LATRUNCULI_MAGICNUMS_H
+
+#include "types.hpp"
+
+// Generated by tools/magics.cpp (seed 1, 1000 candidates per square)
+// Rook and bishop attacks share one overlapping table of 103386 entries
+namespace Magics {
+
+constexpr int SLIDER_TABLE_SIZE = 103386;
+
+constexpr U64 rookMagicNum[64] = {
+    0x0030001800840004ull, 0x0c08040202400005ull, 0x02000a81c0220002ull, 0x2100065001200100ull,
+    0xb200028a00209001ull, 0x0880020080008400ull, 0x040001a241100018ull, 0x22000064c7040012ull,
+    0x0000800cc0001880ull, 0x0506200801700008ull, 0x0000600660140008ull, 0x0002000a00c16004ull,
+    0x0092000600a000b0ull, 0x00020010928a0001ull, 0x9918200244500020ull, 0x0002000048920024ull,
+    0x0004040040820100ull, 0x004000a010080008ull, 0x84010100200a4008ull, 0x0000210010050003ull,
+    0x0300110008010103ull, 0xc112008024008001ull, 0x02801400585000c2ull, 0x0020020000a40021ull,
+    0x1002010400408400ull, 0x8501004400840200ull, 0x4004004400806100ull, 0x0400030500100021ull,
+    0x0100010300100800ull, 0x60c0010100184400ull, 0x0000101400180a81ull, 0x000a800080046300ull,
+    0x0000080830100080ull, 0x0000080830100400ull, 0x06000a0086002040ull, 0x1000044202002010ull,
+    0x000001020d000800ull, 0x0003080101000400ull, 0x285b000080800a00ull, 0x20b00011b0200100ull,
+    0x000008087000e000ull, 0x0040000828102000ull, 0x000040800a060022ull, 0x4c00036201420010ull,
+    0x8000010208010010ull, 0x60002c0001010008ull, 0x020c004120404002ull, 0x0040000206685001ull,
+    0x0100002040813e00ull, 0x040002300a0340c0ull, 0x08012000010e8060ull, 0x100a0000a01c1200ull,
+    0x0400010642208220ull, 0x0400004e00638600ull, 0x01000048081002a0ull, 0x002280000b100060ull,
+    0x0900012048148022ull, 0x0200081024411082ull, 0x408000304580200aull, 0x0000012014884012ull,
+    0x4040008420100853ull, 0x20420000440805a2ull, 0x440000410811208cull, 0x0222000490802446ull};
+
+constexpr int rookMagicShift[64] = {
+    52, 53, 53, 53,
+    53, 53, 53, 52,
+    53, 54, 54, 54,
+    54, 54, 54, 53,
+    53, 54, 54, 54,
+    54, 54, 54, 53,
+    53, 54, 54, 54,
+    54, 54, 54, 53,
+    53, 54, 54, 54,
+    54, 54, 54, 53,
+    53, 54, 54, 54,
+    54, 54, 54, 53,
+    53, 54, 54, 54,
+    54, 54, 54, 53,
+    52, 53, 53, 53,
+    53, 53, 53, 52};
+
+constexpr int rookOffset[64] = {
+    -440, 15899, 17944, 19986,
+    22029, 24076, 26119, 3649,
+    28164, 64814, 65837, 66859,
+    67879, 68896, 69920, 30209,
+    32256, 70938, 71958, 72967,
+    73988, 75011, 76032, 34302,
+    36349, 77053, 78076, 79097,
+    80120, 81132, 82155, 38397,
+    40444, 83178, 84199, 85222,
+    86245, 87266, 88286, 42487,
+    44527, 89247, 90255, 91262,
+    92281, 93240, 94243, 46562,
+    48604, 95132, 96087, 97059,
+    98077, 99098, 99853, 50622,
+    7732, 52655, 54664, 56677,
+    58691, 60728, 62770, 11808};
+
+constexpr U64 bishopMagicNum[64] = {
+    0x2c24a22088050405ull, 0x0288490812080880ull, 0x0028229510109202ull, 0x0014410010004040ull,
+    0x0125430080047800ull, 0x0901212081101004ull, 0x0852080649000080ull, 0x42004c2088018061ull,
+    0x0831150601280820ull, 0x444113038a111002ull, 0x0582080604100041ull, 0x00000820600820c0ull,
+    0x0008098281008400ull, 0x04002242430180d0ull, 0x002c040a02108200ull, 0x00002082a08c4040ull,
+    0x8040006a10841018ull, 0x8010004c4c14e002ull, 0x0030010802842802ull, 0x0404000804140502ull,
+    0x0001040820400820ull, 0x0020800412004000ull, 0x0000804212108041ull, 0x000100084420a022ull,
+    0x01202022108c8080ull, 0x800520020cf84024ull, 0x9001880090201020ull, 0x0901004004040200ull,
+    0x0110010181600804ull, 0x6051010002102000ull, 0x10a8068004cc4040ull, 0x800501c10911d022ull,
+    0x00402154d0101000ull, 0x2100502a40100411ull, 0x0080082800900060ull, 0x000000817c104040ull,
+    0x10001c1400004100ull, 0x0020802030006884ull, 0x0100441120040502ull, 0x000044102d110100ull,
+    0x4240040a42220800ull, 0x8418011430442000ull, 0x2010040406040400ull, 0x8000000414080800ull,
+    0x0080001018600400ull, 0x2820001084384200ull, 0x0801484a02840400ull, 0x00004418a0840200ull,
+    0x4460048889092002ull, 0x0000048161082000ull, 0x0040841a01100400ull, 0x0002060a02090508ull,
+    0x0000000121014221ull, 0x010101100b184000ull, 0x00002034c4064440ull, 0x0000819a10a1f003ull,
+    0x0000006110092300ull, 0x2000000428988910ull, 0x0c0080a004012c04ull, 0x20004888381c4800ull,
+    0x6020104001030444ull, 0x000a0001204c10c0ull, 0x080000d110028190ull, 0x0000081004248095ull};
+
+constexpr int bishopMagicShift[64] = {
+    58, 59, 59, 59,
+    59, 59, 59, 58,
+    59, 59, 59, 59,
+    59, 59, 59, 59,
+    59, 59, 57, 57,
+    57, 57, 59, 59,
+    59, 59, 57, 55,
+    55, 57, 59, 59,
+    59, 59, 57, 55,
+    55, 57, 59, 59,
+    59, 59, 57, 57,
+    57, 57, 59, 59,
+    59, 59, 59, 59,
+    59, 59, 59, 59,
+    58, 59, 59, 59,
+    59, 59, 59, 58};
+
+constexpr int bishopOffset[64] = {
+    2053, 42492, 51122, 56928,
+    51711, 52702, 42525, 51064,
+    7776, 7841, 57184, 42558,
+    57432, 7904, 42736, 7969,
+    42794, 66029, 51581, 102391,
+    94457, 94971, 59416, 8033,
+    43052, 66541, 102516, 1541,
+    100872, 102635, 52767, 89758,
+    42824, 43250, 102761, 101378,
+    101879, 102885, 57696, 43308,
+    57941, 43506, 89437, 103011,
+    103134, 103262, 43565, 43760,
+    52217, 8095, 43792, 90014,
+    58213, 52829, 43340, 8157,
+    52152, 52894, 58453, 58179,
+    52958, 89789, 90046, 42988};
+
+}  // namespace Magics
+
+#endif
@@ -1,6 +1,14 @@
 #ifndef LATRUNCULI_MAGICS_H
 #define LATRUNCULI_MAGICS_H
 
+#ifdef USE_PEXT
+#include <immintrin.h>
+#endif
+
+#include <array>
+#include <bit>
+
+#include "magicnums.hpp"
 #include "types.hpp"
 
 /**
@@ -32,54 +40,11 @@
  */
 
 namespace Magics {
-extern U64 rookAttacksDB[102400];
-
-constexpr U64* rookAttacks[64] = {
-    rookAttacksDB + 86016, rookAttacksDB + 73728, rookAttacksDB + 36864,
-    rookAttacksDB + 43008, rookAttacksDB + 47104, rookAttacksDB + 51200,
-    rookAttacksDB + 77824, rookAttacksDB + 94208, rookAttacksDB + 69632,
-    rookAttacksDB + 32768, rookAttacksDB + 38912, rookAttacksDB + 10240,
-    rookAttacksDB + 14336, rookAttacksDB + 53248, rookAttacksDB + 57344,
-    rookAttacksDB + 81920, rookAttacksDB + 24576, rookAttacksDB + 33792,
-    rookAttacksDB + 6144,  rookAttacksDB + 11264, rookAttacksDB + 15360,
-    rookAttacksDB + 18432, rookAttacksDB + 58368, rookAttacksDB + 61440,
-    rookAttacksDB + 26624, rookAttacksDB + 4096,  rookAttacksDB + 7168,
-    rookAttacksDB + 0,     rookAttacksDB + 2048,  rookAttacksDB + 19456,
-    rookAttacksDB + 22528, rookAttacksDB + 63488, rookAttacksDB + 28672,
-    rookAttacksDB + 5120,  rookAttacksDB + 8192,  rookAttacksDB + 1024,
-    rookAttacksDB + 3072,  rookAttacksDB + 20480, rookAttacksDB + 23552,
-    rookAttacksDB + 65536, rookAttacksDB + 30720, rookAttacksDB + 34816,
-    rookAttacksDB + 9216,  rookAttacksDB + 12288, rookAttacksDB + 16384,
-    rookAttacksDB + 21504, rookAttacksDB + 59392, rookAttacksDB + 67584,
-    rookAttacksDB + 71680, rookAttacksDB + 35840, rookAttacksDB + 39936,
-    rookAttacksDB + 13312, rookAttacksDB + 17408, rookAttacksDB + 54272,
-    rookAttacksDB + 60416, rookAttacksDB + 83968, rookAttacksDB + 90112,
-    rookAttacksDB + 75776, rookAttacksDB + 40960, rookAttacksDB + 45056,
-    rookAttacksDB + 49152, rookAttacksDB + 55296, rookAttacksDB + 79872,
-    rookAttacksDB + 98304};
-constexpr U64 rookMagicNum[64] = {
-    0x0080001020400080ull, 0x0040001000200040ull, 0x0080081000200080ull,
-    0x0080040800100080ull, 0x0080020400080080ull, 0x0080010200040080ull,
-    0x0080008001000200ull, 0x0080002040800100ull, 0x0000800020400080ull,
-    0x0000400020005000ull, 0x0000801000200080ull, 0x0000800800100080ull,
-    0x0000800400080080ull, 0x0000800200040080ull, 0x0000800100020080ull,
-    0x0000800040800100ull, 0x0000208000400080ull, 0x0000404000201000ull,
-    0x0000808010002000ull, 0x0000808008001000ull, 0x0000808004000800ull,
-    0x0000808002000400ull, 0x0000010100020004ull, 0x0000020000408104ull,
-    0x0000208080004000ull, 0x0000200040005000ull, 0x0000100080200080ull,
-    0x0000080080100080ull, 0x0000040080080080ull, 0x0000020080040080ull,
-    0x0000010080800200ull, 0x0000800080004100ull, 0x0000204000800080ull,
-    0x0000200040401000ull, 0x0000100080802000ull, 0x0000080080801000ull,
-    0x0000040080800800ull, 0x0000020080800400ull, 0x0000020001010004ull,
-    0x0000800040800100ull, 0x0000204000808000ull, 0x0000200040008080ull,
-    0x0000100020008080ull, 0x0000080010008080ull, 0x0000040008008080ull,
-    0x0000020004008080ull, 0x0000010002008080ull, 0x0000004081020004ull,
-    0x0000204000800080ull, 0x0000200040008080ull, 0x0000100020008080ull,
-    0x0000080010008080ull, 0x0000040008008080ull, 0x0000020004008080ull,
-    0x0000800100020080ull, 0x0000800041000080ull, 0x00FFFCDDFCED714Aull,
-    0x007FFCDDFCED714Aull, 0x003FFFCDFFD88096ull, 0x0000040810002101ull,
-    0x0001000204080011ull, 0x0001000204000801ull, 0x0001000082000401ull,
-    0x0001FFFAABFAD1A2ull};
+// Rook and bishop attacks share one table, generated at compile time into
+// read only data from the black magics in magicnums.hpp. Each square's
+// slice starts at its offset and may overlap others where entries agree.
+extern const std::array<U64, SLIDER_TABLE_SIZE> sliderAttacksDB;
+
 constexpr U64 rookMagicMask[64] = {
     0x000101010101017Eull, 0x000202020202027Cull, 0x000404040404047Aull,
     0x0008080808080876ull, 0x001010101010106Eull, 0x002020202020205Eull,
@@ -103,61 +68,6 @@ constexpr U64 rookMagicMask[64] = {
     0x7C02020202020200ull, 0x7A04040404040400ull, 0x7608080808080800ull,
     0x6E10101010101000ull, 0x5E20202020202000ull, 0x3E40404040404000ull,
     0x7E80808080808000ull};
-constexpr int rookMagicShift[64] = {
-    52, 53, 53, 53, 53, 53, 53, 52, 53, 54, 54, 54, 54, 54, 54, 53,
-    53, 54, 54, 54, 54, 54, 54, 53, 53, 54, 54, 54, 54, 54, 54, 53,
-    53, 54, 54, 54, 54, 54, 54, 53, 53, 54, 54, 54, 54, 54, 54, 53,
-    53, 54, 54, 54, 54, 54, 54, 53, 53, 54, 54, 53, 53, 53, 53, 53};
-
-extern U64 bishopAttacksDB[5248];
-
-constexpr U64* bishopAttacks[64] = {
-    bishopAttacksDB + 4992, bishopAttacksDB + 2624, bishopAttacksDB + 256,
-    bishopAttacksDB + 896,  bishopAttacksDB + 1280, bishopAttacksDB + 1664,
-    bishopAttacksDB + 4800, bishopAttacksDB + 5120, bishopAttacksDB + 2560,
-    bishopAttacksDB + 2656, bishopAttacksDB + 288,  bishopAttacksDB + 928,
-    bishopAttacksDB + 1312, bishopAttacksDB + 1696, bishopAttacksDB + 4832,
-    bishopAttacksDB + 4928, bishopAttacksDB + 0,    bishopAttacksDB + 128,
-    bishopAttacksDB + 320,  bishopAttacksDB + 960,  bishopAttacksDB + 1344,
-    bishopAttacksDB + 1728, bishopAttacksDB + 2304, bishopAttacksDB + 2432,
-    bishopAttacksDB + 32,   bishopAttacksDB + 160,  bishopAttacksDB + 448,
-    bishopAttacksDB + 2752, bishopAttacksDB + 3776, bishopAttacksDB + 1856,
-    bishopAttacksDB + 2336, bishopAttacksDB + 2464, bishopAttacksDB + 64,
-    bishopAttacksDB + 192,  bishopAttacksDB + 576,  bishopAttacksDB + 3264,
-    bishopAttacksDB + 4288, bishopAttacksDB + 1984, bishopAttacksDB + 2368,
-    bishopAttacksDB + 2496, bishopAttacksDB + 96,   bishopAttacksDB + 224,
-    bishopAttacksDB + 704,  bishopAttacksDB + 1088, bishopAttacksDB + 1472,
-    bishopAttacksDB + 2112, bishopAttacksDB + 2400, bishopAttacksDB + 2528,
-    bishopAttacksDB + 2592, bishopAttacksDB + 2688, bishopAttacksDB + 832,
-    bishopAttacksDB + 1216, bishopAttacksDB + 1600, bishopAttacksDB + 2240,
-    bishopAttacksDB + 4864, bishopAttacksDB + 4960, bishopAttacksDB + 5056,
-    bishopAttacksDB + 2720, bishopAttacksDB + 864,  bishopAttacksDB + 1248,
-    bishopAttacksDB + 1632, bishopAttacksDB + 2272, bishopAttacksDB + 4896,
-    bishopAttacksDB + 5184};
-
-constexpr U64 bishopMagicNum[64] = {
-    0x0002020202020200ull, 0x0002020202020000ull, 0x0004010202000000ull,
-    0x0004040080000000ull, 0x0001104000000000ull, 0x0000821040000000ull,
-    0x0000410410400000ull, 0x0000104104104000ull, 0x0000040404040400ull,
-    0x0000020202020200ull, 0x0000040102020000ull, 0x0000040400800000ull,
-    0x0000011040000000ull, 0x0000008210400000ull, 0x0000004104104000ull,
-    0x0000002082082000ull, 0x0004000808080800ull, 0x0002000404040400ull,
-    0x0001000202020200ull, 0x0000800802004000ull, 0x0000800400A00000ull,
-    0x0000200100884000ull, 0x0000400082082000ull, 0x0000200041041000ull,
-    0x0002080010101000ull, 0x0001040008080800ull, 0x0000208004010400ull,
-    0x0000404004010200ull, 0x0000840000802000ull, 0x0000404002011000ull,
-    0x0000808001041000ull, 0x0000404000820800ull, 0x0001041000202000ull,
-    0x0000820800101000ull, 0x0000104400080800ull, 0x0000020080080080ull,
-    0x0000404040040100ull, 0x0000808100020100ull, 0x0001010100020800ull,
-    0x0000808080010400ull, 0x0000820820004000ull, 0x0000410410002000ull,
-    0x0000082088001000ull, 0x0000002011000800ull, 0x0000080100400400ull,
-    0x0001010101000200ull, 0x0002020202000400ull, 0x0001010101000200ull,
-    0x0000410410400000ull, 0x0000208208200000ull, 0x0000002084100000ull,
-    0x0000000020880000ull, 0x0000001002020000ull, 0x0000040408020000ull,
-    0x0004040404040000ull, 0x0002020202020000ull, 0x0000104104104000ull,
-    0x0000002082082000ull, 0x0000000020841000ull, 0x0000000000208800ull,
-    0x0000000010020200ull, 0x0000000404080200ull, 0x0000040404040400ull,
-    0x0002020202020200ull};
 
 constexpr U64 bishopMagicMask[64] = {
     0x0040201008040200ull, 0x0000402010080400ull, 0x0000004020100A00ull,
@@ -183,33 +93,153 @@ constexpr U64 bishopMagicMask[64] = {
     0x0028440200000000ull, 0x0050080402000000ull, 0x0020100804020000ull,
     0x0040201008040200ull};
 
-constexpr int bishopMagicShift[64] = {
-    58, 59, 59, 59, 59, 59, 59, 58, 59, 59, 59, 59, 59, 59, 59, 59,
-    59, 59, 57, 57, 57, 57, 59, 59, 59, 59, 57, 55, 55, 57, 59, 59,
-    59, 59, 57, 55, 55, 57, 59, 59, 59, 59, 57, 57, 57, 57, 59, 59,
-    59, 59, 59, 59, 59, 59, 59, 59, 58, 59, 59, 59, 59, 59, 59, 58};
+// Reference attacks, rays stepped square by square until blocked
+constexpr U64 initMagicBishop(int square, U64 occupied) {
+    U64 ret = 0;
+    U64 bit = 0;
+    U64 bit2 = 0;
+    U64 rowbits = (U64)0xFF << (8 * (square / 8));
+
+    bit = (U64)1 << square;
+    bit2 = bit;
+    do {
+        bit <<= 8 - 1;
+        bit2 >>= 1;
+        if (bit2 & rowbits)
+            ret |= bit;
+        else
+            break;
+    } while (bit && !(bit & occupied));
+
+    bit = (U64)1 << square;
+    bit2 = bit;
+    do {
+        bit <<= 8 + 1;
+        bit2 <<= 1;
+        if (bit2 & rowbits)
+            ret |= bit;
+        else
+            break;
+    } while (bit && !(bit & occupied));
+
+    bit = (U64)1 << square;
+    bit2 = bit;
+    do {
+        bit >>= 8 - 1;
+        bit2 <<= 1;
+        if (bit2 & rowbits)
+            ret |= bit;
+        else
+            break;
+    } while (bit && !(bit & occupied));
+
+    bit = (U64)1 << square;
+    bit2 = bit;
+    do {
+        bit >>= 8 + 1;
+        bit2 >>= 1;
+        if (bit2 & rowbits)
+            ret |= bit;
+        else
+            break;
+    } while (bit && !(bit & occupied));
+
+    return ret;
+}
 
-void init();
+constexpr U64 initMagicRook(int square, U64 occupied) {
+    U64 ret = 0;
+    U64 bit = 0;
+    U64 rowbits = (U64)0xFF << 8 * (square / 8);
+
+    bit = (U64)1 << square;
+    do {
+        bit <<= 8;
+        ret |= bit;
+    } while (bit && !(bit & occupied));
+
+    bit = (U64)1 << square;
+    do {
+        bit >>= 8;
+        ret |= bit;
+    } while (bit && !(bit & occupied));
+
+    bit = (U64)1 << square;
+    do {
+        bit <<= 1;
+        if (bit & rowbits)
+            ret |= bit;
+        else
+            break;
+    } while (!(bit & occupied));
+
+    bit = (U64)1 << square;
+    do {
+        bit >>= 1;
+        if (bit & rowbits)
+            ret |= bit;
+        else
+            break;
+    } while (!(bit & occupied));
+
+    return ret;
+}
 
-U64 initOccupied(int* squares, int numSquares, U64 line_occupied);
-U64 initMagicBishop(int square, U64 occupied);
-U64 initMagicRook(int square, U64 occupied);
+bool supported();
+bool verify();
 
-constexpr U64 getRookAttacks(Square sq, U64 occ) {
-    auto occupancy = occ & Magics::rookMagicMask[sq];
-    auto index =
-        (occupancy * Magics::rookMagicNum[sq]) >> Magics::rookMagicShift[sq];
-    return Magics::rookAttacks[sq][index];
+// Black magics fill in every square outside the mask instead of clearing it
+constexpr std::array<U64, 64> invert(const U64 (&masks)[64]) {
+    std::array<U64, 64> inverted{};
+    for (int sq = 0; sq < 64; sq++) inverted[sq] = ~masks[sq];
+    return inverted;
 }
 
-constexpr U64 getBishopAttacks(Square sq, U64 occ) {
-    auto occupancy = occ & Magics::bishopMagicMask[sq];
-    auto index = (occupancy * Magics::bishopMagicNum[sq]) >>
-                 Magics::bishopMagicShift[sq];
-    return Magics::bishopAttacks[sq][index];
+constexpr auto rookNotMask = invert(rookMagicMask);
+constexpr auto bishopNotMask = invert(bishopMagicMask);
+
+constexpr U64 getRookAttacksMagic(Square sq, U64 occ) {
+    auto index = ((occ | rookNotMask[sq]) * rookMagicNum[sq]) >> rookMagicShift[sq];
+    return sliderAttacksDB[rookOffset[sq] + index];
+}
+
+constexpr U64 getBishopAttacksMagic(Square sq, U64 occ) {
+    auto index = ((occ | bishopNotMask[sq]) * bishopMagicNum[sq]) >> bishopMagicShift[sq];
+    return sliderAttacksDB[bishopOffset[sq] + index];
 }
 
-constexpr U64 getQueenAttacks(Square sq, U64 occ) {
+#ifdef USE_PEXT
+// BMI2 backend, the occupancy under the mask is packed straight into an
+// index, so the tables are dense and need no magic numbers or shifts
+constexpr std::array<int, 64> pextOffsets(const U64 (&masks)[64]) {
+    std::array<int, 64> offsets{};
+    for (int sq = 1; sq < 64; sq++)
+        offsets[sq] = offsets[sq - 1] + (1 << std::popcount(masks[sq - 1]));
+    return offsets;
+}
+
+constexpr auto rookPextOffset = pextOffsets(rookMagicMask);
+constexpr auto bishopPextOffset = pextOffsets(bishopMagicMask);
+
+extern const std::array<U64, 102400> rookPextDB;
+extern const std::array<U64, 5248> bishopPextDB;
+
+inline U64 getRookAttacksPext(Square sq, U64 occ) {
+    return rookPextDB[rookPextOffset[sq] + _pext_u64(occ, rookMagicMask[sq])];
+}
+
+inline U64 getBishopAttacksPext(Square sq, U64 occ) {
+    return bishopPextDB[bishopPextOffset[sq] + _pext_u64(occ, bishopMagicMask[sq])];
+}
+
+inline U64 getRookAttacks(Square sq, U64 occ) { return getRookAttacksPext(sq, occ); }
+inline U64 getBishopAttacks(Square sq, U64 occ) { return getBishopAttacksPext(sq, occ); }
+#else
+constexpr U64 getRookAttacks(Square sq, U64 occ) { return getRookAttacksMagic(sq, occ); }
+constexpr U64 getBishopAttacks(Square sq, U64 occ) { return getBishopAttacksMagic(sq, occ); }
+#endif
+
+inline U64 getQueenAttacks(Square sq, U64 occ) {
     return getBishopAttacks(sq, occ) | getRookAttacks(sq, occ);
 }
 
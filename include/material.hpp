@@ -0,0 +1,46 @@
+#ifndef LATRUNCULI_MATERIAL_H
+#define LATRUNCULI_MATERIAL_H
+
+#include <vector>
+
+#include "board.hpp"
+#include "endgame.hpp"
+#include "types.hpp"
+
+namespace Material {
+
+// Everything the eval needs that depends only on the material on the board
+struct Entry {
+    U64 key = ~0ull;
+    Endgame::EvalFn evaluator = nullptr;
+    Color strongSide = WHITE;
+    U8 phase = 0;
+    U8 scale[N_COLORS] = {};
+    bool oppositeBishops = false;
+};
+
+class Table {
+   private:
+    static const int BITS = 13;
+    std::vector<Entry> entries = std::vector<Entry>(1 << BITS);
+
+   public:
+    Entry* probe(const Board&);
+};
+
+// One table per thread, so searches on different threads never share entries
+extern thread_local Table table;
+
+void init(Entry&, const Board&);
+
+inline Entry* Table::probe(const Board& board) {
+    // The packed key has little entropy in its low bits, hash it first
+    U64 key = board.materialKey;
+    Entry* entry = &entries[(key * 0x9E3779B97F4A7C15ull) >> (64 - BITS)];
+    if (entry->key != key) init(*entry, board);
+    return entry;
+}
+
+}  // namespace Material
+
+#endif
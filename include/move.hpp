@@ -21,7 +21,7 @@ struct Move {
     inline MoveType type() const { return unpackType(value); }
     inline PieceType promoPiece() const { return unpackPromoPiece(value); }
 
-    inline bool isNullMove() const { return value == 0; }
+    constexpr bool isNullMove() const { return value == 0; }
     inline bool operator<(const Move& rhs) const { return score < rhs.score; }
     inline bool operator==(const Move& rhs) const { return value == rhs.value; }
 
@@ -0,0 +1,45 @@
+#ifndef LATRUNCULI_OUTPUT_H
+#define LATRUNCULI_OUTPUT_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Text for a stream written from a thread of its own, so the search never
+// waits on a slow reader. Writers only append to a buffer, the thread takes
+// whatever gathered in the meantime and writes it with a single flush.
+class Output {
+   private:
+    std::ostream& os;
+    std::string buffer;
+    std::mutex mutex;
+    std::condition_variable hasText;
+    std::condition_variable drained;
+    bool writing = false;
+    bool stopping = false;
+    std::thread writer;
+
+    void writerLoop();
+
+   public:
+    // Text posted while this much is still waiting for the reader is dropped
+    static constexpr size_t MAX_BACKLOG = 1 << 16;
+
+    explicit Output(std::ostream&);
+    ~Output();
+
+    Output(const Output&) = delete;
+    Output& operator=(const Output&) = delete;
+
+    void write(std::string_view);
+    bool post(std::string_view);
+    void flush();
+
+    static Output& console();
+};
+
+#endif
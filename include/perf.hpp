@@ -0,0 +1,51 @@
+#ifndef LATRUNCULI_PERF_H
+#define LATRUNCULI_PERF_H
+
+#include <chrono>
+#include <iostream>
+
+#include "types.hpp"
+
+// Hardware performance counters around a region of code, compiled in with
+// the PERF_COUNTERS CMake option. Without it, or where perf_event_open is
+// refused (containers, perf_event_paranoid), only wall clock time is taken.
+namespace Perf {
+
+#ifdef PERF_COUNTERS
+constexpr bool ENABLED = true;
+#else
+constexpr bool ENABLED = false;
+#endif
+
+enum Event { CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, BRANCH_MISSES, N_EVENTS };
+
+struct Sample {
+    double seconds = 0;
+    U64 counts[N_EVENTS] = {};
+    bool counted[N_EVENTS] = {};
+
+    bool any() const;
+};
+
+// Per node rates of a sample, e.g. " ipc 2.31 l1d-misses/node 4.2"
+std::ostream& print(std::ostream&, const Sample&, U64 nodes);
+
+class Counters {
+   private:
+    int fds[N_EVENTS];
+    std::chrono::steady_clock::time_point begin;
+
+   public:
+    Counters();
+    ~Counters();
+
+    Counters(const Counters&) = delete;
+    Counters& operator=(const Counters&) = delete;
+
+    void start();
+    Sample stop();
+};
+
+}  // namespace Perf
+
+#endif
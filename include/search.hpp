@@ -2,17 +2,37 @@
 #define LATRUNCULI_SEARCH_H
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstring>
 #include <iterator>
 #include <memory>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "move.hpp"
+#include "output.hpp"
+#include "stats.hpp"
+#include "tt.hpp"
 #include "types.hpp"
 
 class Chess;
 
+extern int MATESCORE;
+extern int DRAWSCORE;
+
+// Limits of a search, zero means unlimited. Infinite and pondering
+// searches hold their best move back until stopped, a ponder search only
+// starts its clock on ponderhit.
+struct SearchLimits {
+    int depth = 0;
+    U64 nodes = 0;
+    int movetime = 0;
+    bool infinite = false;
+    bool ponder = false;
+};
+
 struct Killer {
     Move move1;
     Move move2;
@@ -20,28 +40,49 @@ struct Killer {
 
 class Search {
    public:
-    Search() = default;
-    Search(Chess* chess) : bestMove(Move()), chess(chess), searchPly(0), nSearched(0) {}
+    // Each search has a transposition table of its own, hashMB in size
+    explicit Search(Chess* chess, size_t hashMB = TT::DEFAULT_HASH)
+        : bestMove(Move()), tt(hashMB), chess(chess), searchPly(0), nSearched(0) {}
+    ~Search() {
+        stopThinking();
+        wait();
+    }
 
     /*
      *  search.cpp
      */
 
     void think(int);
+    void think(const SearchLimits&);
+
+    // Think on a thread of its own. Stopping and ponderhit are safe to call
+    // from any thread while it runs, wait returns once it has finished.
+    void startThinking(const SearchLimits&);
+    void stopThinking() { stopRequest = true; }
+    void ponderhit() { pondering = false; }
+    void wait();
 
     template <bool>
     int negamax(int, int, int, bool = true, bool = true);
-    int quiesce(int, int);
+    int quiesce(int, int, int = 0);
 
     template <bool, bool = true>
     U64 perft(int);
 
     void reset();
+    void newGame();
     void sortMoves(std::vector<Move>&, Move = Move());
 
+    U64 getNodes() const { return nSearched; }
+
     Move bestMove;
     int bestScore = 0;
+    bool silent = false;
+    Output* output = &Output::console();
+    TT::Table tt;
+    [[no_unique_address]] SearchStats<STATS_ENABLED> stats;
     const static int MAX_DEPTH = 64;
+    const static int INFO_INTERVAL = 100;
 
    private:
     // Board to search
@@ -50,17 +91,32 @@ class Search {
     // Main search variables
     std::vector<Move> pv[MAX_DEPTH];
     I32 searchPly;
-    U32 history[2][N_PIECES-1][64];
+    U32 history[2][N_PIECES-1][64] = {};
     Killer killers[MAX_DEPTH];
 
+    // Search limits, stopped unwinds the search once one is hit
+    SearchLimits limits;
+    bool stopped = false;
+
+    // Signals from other threads to a search started on its own thread
+    std::thread thread;
+    std::atomic<bool> stopRequest = false;
+    std::atomic<bool> pondering = false;
+
     // Search statistics variables
-    U32 nSearched;
+    U64 nSearched;
     std::chrono::high_resolution_clock::time_point start, stop;
 
+    // Latest info not yet shown, and when the last one was
+    std::string pendingInfo;
+    std::chrono::high_resolution_clock::time_point lastInfo;
+
     // Helper methods
+    void checkLimits();
     void addToHistory(Move move, int ply);
     void savePV(Move move);
-    void printPV(int, int, unsigned int);
+    void printPV(int, int, U64);
+    void showInfo(bool);
 };
 
 #endif
\ No newline at end of file
@@ -16,7 +16,8 @@ struct State {
         : zkey(state.zkey)
         , move(mv)
         , castle(state.castle)
-        , hmClock(state.hmClock + 1) {}
+        , hmClock(state.hmClock + 1)
+        , pliesFromNull(state.pliesFromNull + 1) {}
 
     // Check info bitboards
     U64 checkingPieces = 0;
@@ -33,6 +34,7 @@ struct State {
     CastleRights castle = ALL_CASTLE;
     Square enPassantSq = INVALID;
     U8 hmClock = 0;
+    U16 pliesFromNull = 0;
 
     inline bool canCastle(Color c) const {
         // Check if the specified color can castle
@@ -0,0 +1,107 @@
+#ifndef LATRUNCULI_STATS_H
+#define LATRUNCULI_STATS_H
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#include "types.hpp"
+
+// Search statistics for tuning pruning and move ordering, compiled in with
+// the SEARCH_STATS CMake option. Otherwise every update is an empty inline
+// function and the counters take no space in Search.
+
+#ifdef SEARCH_STATS
+constexpr bool STATS_ENABLED = true;
+#else
+constexpr bool STATS_ENABLED = false;
+#endif
+
+enum Stat {
+    PV_NODES,
+    NON_PV_NODES,
+    QSEARCH_NODES,
+    EXACT_NODES,
+    CUT_NODES,
+    ALL_NODES,
+    FIRST_MOVE_CUTOFFS,
+    TT_PROBES,
+    TT_HITS,
+    TT_CUTOFFS,
+    NULL_MOVE_TRIES,
+    NULL_MOVE_CUTOFFS,
+    LMR_REDUCTIONS,
+    LMR_RESEARCHES,
+    N_STATS
+};
+
+template <bool Enabled>
+class SearchStats {
+   public:
+    static constexpr int QSEARCH_DEPTHS = 16;
+
+    void clear() { *this = SearchStats(); }
+    void add(Stat stat) { counts[stat]++; }
+    void qsearchDepth(int depth) { qsearch[std::min(depth, QSEARCH_DEPTHS - 1)]++; }
+
+    U64 get(Stat stat) const { return counts[stat]; }
+    U64 getQsearchDepth(int depth) const { return qsearch[depth]; }
+
+    template <bool E>
+    friend std::ostream& operator<<(std::ostream&, const SearchStats<E>&);
+
+   private:
+    U64 counts[N_STATS] = {};
+    U64 qsearch[QSEARCH_DEPTHS] = {};
+
+    static double percent(U64 part, U64 whole) { return whole ? 100.0 * part / whole : 0; }
+};
+
+template <>
+class SearchStats<false> {
+   public:
+    void clear() {}
+    void add(Stat) {}
+    void qsearchDepth(int) {}
+
+    U64 get(Stat) const { return 0; }
+    U64 getQsearchDepth(int) const { return 0; }
+};
+
+template <bool Enabled>
+std::ostream& operator<<(std::ostream& os, const SearchStats<Enabled>& stats) {
+    auto flags = os.flags();
+    auto precision = os.precision();
+    os << std::fixed << std::setprecision(1);
+
+    auto& c = stats.counts;
+    auto percent = SearchStats<Enabled>::percent;
+
+    os << "nodes pv " << c[PV_NODES] << " non-pv " << c[NON_PV_NODES] << " qsearch "
+       << c[QSEARCH_NODES] << "\n";
+    os << "node types exact " << c[EXACT_NODES] << " cut " << c[CUT_NODES] << " all "
+       << c[ALL_NODES] << "\n";
+    os << "first move cutoffs " << c[FIRST_MOVE_CUTOFFS] << " ("
+       << percent(c[FIRST_MOVE_CUTOFFS], c[CUT_NODES]) << "%)\n";
+    os << "tt probes " << c[TT_PROBES] << " hits " << c[TT_HITS] << " ("
+       << percent(c[TT_HITS], c[TT_PROBES]) << "%) cutoffs " << c[TT_CUTOFFS] << "\n";
+    os << "null move tries " << c[NULL_MOVE_TRIES] << " cutoffs " << c[NULL_MOVE_CUTOFFS] << " ("
+       << percent(c[NULL_MOVE_CUTOFFS], c[NULL_MOVE_TRIES]) << "%)\n";
+    os << "lmr reductions " << c[LMR_REDUCTIONS] << " re-searches " << c[LMR_RESEARCHES] << " ("
+       << percent(c[LMR_RESEARCHES], c[LMR_REDUCTIONS]) << "%)\n";
+
+    os << "qsearch depth";
+    for (int d = 0; d < SearchStats<Enabled>::QSEARCH_DEPTHS; ++d) {
+        if (stats.qsearch[d]) os << " " << d << ":" << stats.qsearch[d];
+    }
+
+    os.flags(flags);
+    os.precision(precision);
+    return os;
+}
+
+inline std::ostream& operator<<(std::ostream& os, const SearchStats<false>&) {
+    return os << "search statistics are disabled, build with -DSEARCH_STATS=ON";
+}
+
+#endif
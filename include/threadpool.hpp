@@ -0,0 +1,53 @@
+#ifndef LATRUNCULI_THREADPOOL_H
+#define LATRUNCULI_THREADPOOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads fed from a shared job queue
+class ThreadPool {
+   private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable jobsDone;
+    size_t pending = 0;
+    bool stopping = false;
+
+    void workerLoop();
+
+   public:
+    explicit ThreadPool(size_t = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+    void submit(std::function<void()>);
+    void wait();
+
+    template <typename F>
+    void parallelFor(size_t, F&&);
+};
+
+template <typename F>
+inline void ThreadPool::parallelFor(size_t n, F&& f) {
+    // Split [0, n) into one contiguous chunk per worker, f(worker, begin, end)
+    size_t nChunks = std::min(size(), n);
+    for (size_t i = 0; i < nChunks; ++i) {
+        size_t begin = n * i / nChunks;
+        size_t end = n * (i + 1) / nChunks;
+        submit([&f, i, begin, end] { f(i, begin, end); });
+    }
+    wait();
+}
+
+#endif
@@ -1,7 +1,9 @@
 #ifndef LATRUNCULI_TT_H
 #define LATRUNCULI_TT_H
 
+#include <cstddef>
 #include <iostream>
+#include <memory>
 
 #include "move.hpp"
 #include "types.hpp"
@@ -38,23 +40,23 @@ struct Entry {
     // void update(U64, int, U8, NodeType, Move);
 };
 
+// Size of a table when none is given, in MB
+constexpr size_t DEFAULT_HASH = 16;
+
 class Table {
    private:
-    Entry* _table;
-    U32 _size = 0;
+    std::unique_ptr<Entry[]> _table;
+    size_t _size = 0;
 
    public:
-    void init(U32);
+    void resize(size_t);
+    void clear();
     void save(U64, U8, int, NodeType, Move);
     Entry* probe(U64) const;
 
-    Table() { init(16777216); }
-
-    ~Table() { delete[] _table; }
+    explicit Table(size_t mb = DEFAULT_HASH) { resize(mb); }
 };
 
-extern Table table;
-
 // inline void Entry::update(U64 _zkey, int _score, U8 _depth, NodeType _flag,
 // Move _best)
 // {
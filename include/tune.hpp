@@ -0,0 +1,90 @@
+#ifndef LATRUNCULI_TUNE_H
+#define LATRUNCULI_TUNE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "threadpool.hpp"
+#include "types.hpp"
+
+namespace Tune {
+
+// Parameter layout: piece values for PAWN..QUEEN, then one piece square
+// table of 64 entries per piece type PAWN..KING, then the pawn penalties
+const int PIECE_VALUES = 0;
+const int PIECE_SQUARES = PIECE_VALUES + 5;
+const int ISO_PAWN = PIECE_SQUARES + (N_PIECES - PAWN) * 64;
+const int BACKWARD_PAWN = ISO_PAWN + 1;
+const int DOUBLED_PAWN = BACKWARD_PAWN + 1;
+const int N_PARAMS = DOUBLED_PAWN + 1;
+
+struct Weight {
+    double mg = 0;
+    double eg = 0;
+};
+
+using Params = std::vector<Weight>;
+
+inline int pieceSquareIndex(PieceType pt, int sq) { return PIECE_SQUARES + (pt - PAWN) * 64 + sq; }
+
+// Number of times a parameter is counted for white minus for black
+struct Feature {
+    U16 index;
+    I8 coeff;
+};
+
+// One labeled position, reduced to what the linearized eval needs. Eval
+// terms which aren't tuned are folded into fixedMg/fixedEg.
+struct Entry {
+    float result;
+    U8 phase;
+    U8 scale;
+    I8 tempo;
+    I16 fixedMg;
+    I16 fixedEg;
+    U32 offset;
+    U8 nFeatures;
+};
+
+class Dataset {
+   public:
+    std::vector<Entry> entries;
+    std::vector<Feature> features;
+
+    bool add(const std::string&, float);
+    size_t convert(std::istream&);
+    bool save(const std::string&) const;
+    bool load(const std::string&);
+    size_t size() const { return entries.size(); }
+};
+
+bool parseResult(const std::string&, float&);
+
+Params initialParams();
+double linearEval(const Dataset&, const Entry&, const Params&);
+double sigmoid(double, double);
+
+double loss(const Dataset&, const Params&, double, ThreadPool&);
+void gradient(const Dataset&, const Params&, double, ThreadPool&, Params&);
+double fitK(const Dataset&, const Params&, ThreadPool&);
+
+struct Adam {
+    double rate;
+    double beta1 = 0.9;
+    double beta2 = 0.999;
+    double epsilon = 1e-8;
+    int t = 0;
+    Params m = Params(N_PARAMS);
+    Params v = Params(N_PARAMS);
+
+    explicit Adam(double _rate) : rate(_rate) {}
+    void step(Params&, const Params&);
+};
+
+void tune(const Dataset&, Params&, int, double, ThreadPool&, std::ostream&);
+void writeHeader(std::ostream&, const Params&);
+
+}  // namespace Tune
+
+#endif
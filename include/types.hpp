@@ -76,6 +76,28 @@ enum class PawnMove { LEFT = 7, PUSH = 8, RIGHT = 9, DOUBLE = 16 };
 
 enum Phase { MIDGAME, ENDGAME, N_PHASES };
 
+// Packed midgame/endgame score: the midgame value lives in the lower 16 bits
+// and the endgame value in the upper 16 bits, so both are updated by one add
+enum Score : int { SCORE_ZERO };
+
+inline constexpr Score makeScore(int mg, int eg) {
+    return Score(static_cast<int>(static_cast<unsigned int>(eg) << 16) + mg);
+}
+
+inline constexpr int mgValue(Score s) {
+    return static_cast<I16>(static_cast<U16>(static_cast<unsigned int>(s)));
+}
+
+inline constexpr int egValue(Score s) {
+    // Round up, the lower half borrows from the upper half when negative
+    return static_cast<I16>(static_cast<U16>(static_cast<unsigned int>(s + 0x8000) >> 16));
+}
+
+template <Phase ph>
+inline constexpr int scoreValue(Score s) {
+    return ph == MIDGAME ? mgValue(s) : egValue(s);
+}
+
 // Operators
 
 inline Color operator~(Color c) { return Color(c ^ WHITE); }
@@ -121,6 +143,14 @@ inline std::ostream& operator<<(std::ostream& os, Piece p) {
     inline constexpr T& operator&=(T& d1, T d2) { return d1 = T(d1 & d2); }   \
     inline constexpr T& operator|=(T& d1, T d2) { return d1 = T(d1 | d2); }
 
+inline constexpr Score operator+(Score s1, Score s2) { return Score(int(s1) + int(s2)); }
+inline constexpr Score operator-(Score s1, Score s2) { return Score(int(s1) - int(s2)); }
+inline constexpr Score operator-(Score s) { return Score(-int(s)); }
+inline constexpr Score operator*(Score s, int i) { return Score(int(s) * i); }
+inline constexpr Score operator*(int i, Score s) { return Score(i * int(s)); }
+inline constexpr Score& operator+=(Score& s1, Score s2) { return s1 = s1 + s2; }
+inline constexpr Score& operator-=(Score& s1, Score s2) { return s1 = s1 - s2; }
+
 ENABLE_OPERATORS(Square)
 ENABLE_OPERATORS(File)
 ENABLE_OPERATORS(Rank)
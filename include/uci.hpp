@@ -1,34 +1,79 @@
 #ifndef LATRUNCULI_UCI_H
 #define LATRUNCULI_UCI_H
 
+#include <algorithm>
+#include <sstream>
 #include <string>
+#include <string_view>
 
+#include "book.hpp"
 #include "chess.hpp"
+#include "output.hpp"
 #include "search.hpp"
 
 // Universal Chess Interface (UCI)
 // http://wbec-ridderkerk.nl/html/UCIProtocol.html
 namespace UCI {
 
+// Words of a command line, read in place without copying
+class Tokenizer {
+   private:
+    std::string_view rest;
+
+   public:
+    explicit Tokenizer(std::string_view line) : rest(line) {}
+
+    // The next word, empty once there are none left
+    std::string_view next() {
+        constexpr std::string_view SPACE = " \t\r\n";
+        size_t begin = std::min(rest.find_first_not_of(SPACE), rest.size());
+        rest.remove_prefix(begin);
+        size_t end = std::min(rest.find_first_of(SPACE), rest.size());
+        std::string_view word = rest.substr(0, end);
+        rest.remove_prefix(end);
+        return word;
+    }
+};
+
 class Controller {
    public:
     Controller(std::istream&, std::ostream&);
+    ~Controller();
     void loop();
-    bool execute(const std::string& input);
+    bool execute(std::string_view input);
+
+    // Waits for the search started by go, stopping it when it has no limits
+    void wait();
 
    private:
     Chess chess;
     Search search;
     bool _debug;
+    bool ownBook;
+    Book::Reader book;
     std::istream& istream;
-    std::ostream& ostream;
+
+    // Replies to the command being executed, written to output once done
+    std::ostringstream reply;
+
+    // Search output, drained before each command returns
+    Output output;
+
+    // Limits of the search started last
+    SearchLimits running;
+
+    // Position last set up, so a resent game only plays its new moves
+    std::string positionFen;
+    std::vector<std::string> positionMoves;
 
     void uci();
-    void setdebug(std::vector<std::string>& tokens);
-    void position(std::vector<std::string>& tokens);
-    void go(std::vector<std::string>& tokens);
-    void move(std::vector<std::string>& tokens);
+    void setdebug(Tokenizer& tokens);
+    void setoption(Tokenizer& tokens);
+    void position(Tokenizer& tokens);
+    void go(Tokenizer& tokens);
+    void move(Tokenizer& tokens);
     void moves();
+    Move parseMove(std::string_view);
 };
 
 }  // namespace UCI
@@ -1,17 +1,67 @@
 #ifndef LATRUNCULI_ZOBRIST_H
 #define LATRUNCULI_ZOBRIST_H
 
+#include <array>
+
+#include "move.hpp"
+#include "polyglot.hpp"
 #include "types.hpp"
 
+// Hash keys generated at compile time, readable from static initialization
+// on and shared read only between processes
 namespace Zobrist {
 
-void init();
+// SplitMix64, small enough to run in constant evaluation
+// https://prng.di.unimi.it/splitmix64.c
+class PRNG {
+   private:
+    U64 state;
+
+   public:
+    constexpr explicit PRNG(U64 seed) : state(seed) {}
+
+    constexpr U64 next() {
+        U64 z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+};
+
+struct Keys {
+    std::array<std::array<std::array<U64, N_SQUARES>, N_PIECES>, N_COLORS> psq{};
+    U64 stm = 0;
+    std::array<U64, 8> ep{};
+    std::array<std::array<U64, 2>, N_COLORS> castle{};
+};
+
+inline constexpr Keys keys = [] {
+    PRNG rng(0x4C617472756E6375);
+    Keys k;
+    for (auto& side : k.psq)
+        for (auto& piece : side)
+            for (auto& key : piece) key = rng.next();
+    k.stm = rng.next();
+    for (auto& key : k.ep) key = rng.next();
+    for (auto& side : k.castle)
+        for (auto& key : side) key = rng.next();
+    return k;
+}();
+
+inline constexpr const auto& psq = keys.psq;
+inline constexpr const U64& stm = keys.stm;
+inline constexpr const auto& ep = keys.ep;
+inline constexpr const auto& castle = keys.castle;
+
+// Key differences of every reversible piece move, for detecting upcoming
+// repetitions. Cuckoo hashed with two probe locations per key.
+constexpr int CUCKOO_SIZE = 8192;
+extern const std::array<U64, CUCKOO_SIZE> cuckoo;
+extern const std::array<Move, CUCKOO_SIZE> cuckooMove;
 
-extern U64 psq[N_COLORS][N_PIECES][N_SQUARES];
-extern U64 stm;
-extern U64 ep[8];
-extern U64 castle[N_COLORS][2];
+constexpr int cuckooH1(U64 key) { return key & (CUCKOO_SIZE - 1); }
+constexpr int cuckooH2(U64 key) { return (key >> 16) & (CUCKOO_SIZE - 1); }
 
 }  // namespace Zobrist
 
-#endif
\ No newline at end of file
+#endif
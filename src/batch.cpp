@@ -0,0 +1,406 @@
+#include "batch.hpp"
+
+#include <bit>
+
+#ifdef USE_AVX2
+#include <immintrin.h>
+#endif
+
+#include "bb.hpp"
+#include "constants.hpp"
+
+namespace {
+
+constexpr U64 NOT_A = ~BB::FILE_MASK[FILE1];
+constexpr U64 NOT_H = ~BB::FILE_MASK[FILE8];
+constexpr U64 NOT_AB = ~(BB::FILE_MASK[FILE1] | BB::FILE_MASK[FILE2]);
+constexpr U64 NOT_GH = ~(BB::FILE_MASK[FILE7] | BB::FILE_MASK[FILE8]);
+
+// One position per register, the portable fallback
+struct Scalar {
+    static constexpr size_t N = 1;
+    U64 v;
+
+    static Scalar load(const U64* p) { return {*p}; }
+    static Scalar of(U64 x) { return {x}; }
+    void store(U64* p) const { *p = v; }
+};
+
+inline Scalar operator&(Scalar a, Scalar b) { return {a.v & b.v}; }
+inline Scalar operator|(Scalar a, Scalar b) { return {a.v | b.v}; }
+inline Scalar operator^(Scalar a, Scalar b) { return {a.v ^ b.v}; }
+inline Scalar operator+(Scalar a, Scalar b) { return {a.v + b.v}; }
+inline Scalar operator-(Scalar a, Scalar b) { return {a.v - b.v}; }
+inline Scalar operator~(Scalar a) { return {~a.v}; }
+inline Scalar andNot(Scalar a, Scalar b) { return {~a.v & b.v}; }
+inline Scalar isZero(Scalar a) { return {a.v ? 0 : ~0ull}; }
+inline Scalar popcount(Scalar a) { return {U64(std::popcount(a.v))}; }
+inline Scalar byteswap(Scalar a) { return {__builtin_bswap64(a.v)}; }
+inline bool any(Scalar a) { return a.v; }
+
+template <int s>
+inline Scalar shift(Scalar a) {
+    if constexpr (s > 0)
+        return {a.v << s};
+    else
+        return {a.v >> -s};
+}
+
+template <typename V>
+inline V select(V mask, V a, V b) {
+    return (mask & a) | andNot(mask, b);
+}
+
+template <typename V>
+inline V nonZero(V a) {
+    return ~isZero(a);
+}
+
+template <typename V>
+inline V lowest(V a) {
+    return a & (V::of(0) - a);
+}
+
+// Attacks of the sliders in gen along the diagonals or straight lines,
+// filled the same way as BB::slidingAttacks
+template <typename V>
+inline V diagonal(V gen, V empty) {
+    return BB::occludedFill<9>(gen, empty) | BB::occludedFill<7>(gen, empty) |
+           BB::occludedFill<-7>(gen, empty) | BB::occludedFill<-9>(gen, empty);
+}
+
+template <typename V>
+inline V straight(V gen, V empty) {
+    return BB::occludedFill<8>(gen, empty) | BB::occludedFill<-8>(gen, empty) |
+           BB::occludedFill<1>(gen, empty) | BB::occludedFill<-1>(gen, empty);
+}
+
+template <typename V>
+inline V knightAttacks(V b) {
+    V one = (shift<1>(b) & V::of(NOT_A)) | (shift<-1>(b) & V::of(NOT_H));
+    V two = (shift<2>(b) & V::of(NOT_AB)) | (shift<-2>(b) & V::of(NOT_GH));
+    return shift<16>(one) | shift<-16>(one) | shift<8>(two) | shift<-8>(two);
+}
+
+template <typename V>
+inline V kingAttacks(V b) {
+    V row = (shift<1>(b) & V::of(NOT_A)) | (shift<-1>(b) & V::of(NOT_H));
+    V three = b | row;
+    return row | shift<8>(three) | shift<-8>(three);
+}
+
+template <bool north, typename V>
+inline V pawnAttacks(V b) {
+    if constexpr (north)
+        return (shift<9>(b) & V::of(NOT_A)) | (shift<7>(b) & V::of(NOT_H));
+    else
+        return (shift<-7>(b) & V::of(NOT_A)) | (shift<-9>(b) & V::of(NOT_H));
+}
+
+// Squares attacked by one side, setwise over all of its pieces
+template <bool north, typename V>
+V attackMap(const V (&pieces)[N_PIECES], V empty) {
+    return pawnAttacks<north>(pieces[PAWN]) | knightAttacks(pieces[KNIGHT]) |
+           kingAttacks(pieces[KING]) | diagonal(pieces[BISHOP] | pieces[QUEEN], empty) |
+           straight(pieces[ROOK] | pieces[QUEEN], empty);
+}
+
+// Pawn moves north onto targets, a promotion counting once per piece
+template <typename V>
+V pawnMoves(V pawns, V targets, V empty, V enemies) {
+    V push = shift<8>(pawns) & empty;
+    V twice = shift<8>(push & V::of(BB::RANK_MASK[RANK3])) & empty & targets;
+    push = push & targets;
+    V left = shift<7>(pawns) & V::of(NOT_H) & enemies & targets;
+    V right = shift<9>(pawns) & V::of(NOT_A) & enemies & targets;
+
+    V last = V::of(BB::RANK_MASK[RANK8]);
+    V promotions = popcount(push & last) + popcount(left & last) + popcount(right & last);
+    return popcount(push) + popcount(twice) + popcount(left) + popcount(right) + promotions +
+           promotions + promotions;
+}
+
+// Whether taking en passant from a square leaves the king safe: with both
+// pawns gone from their rank a slider may see it
+template <typename V>
+V enPassantSafe(V from, V ep, V king, V occ, V diagonals, V straights) {
+    V empty = ~((occ ^ from ^ shift<-8>(ep)) | ep);
+    V exposed = (diagonal(king, empty) & diagonals) | (straight(king, empty) & straights);
+    return nonZero(from) & isZero(exposed);
+}
+
+// Ray from the king in direction s, noting checks and pins along it
+template <int s, typename V>
+void kingRay(V king, V empty, V own, V sliders, V& checkers, V& evasions, V& pinned, V& line) {
+    V ray = BB::occludedFill<s>(king, empty);
+    V checker = ray & sliders;
+    checkers = checkers | checker;
+    evasions = evasions | (nonZero(checker) & ray);
+
+    // Seen through our first piece a slider pins it to the ray
+    V blocker = ray & own;
+    line = BB::occludedFill<s>(king, empty | blocker);
+    pinned = nonZero(line & sliders) & blocker;
+}
+
+// Moves of each piece in turn, all lanes popping their next piece together
+template <typename V, typename Attacks>
+void pieceMoves(V pieces, V targets, const V (&pinned)[8], const V (&lines)[8], V& pseudo,
+                V& legal, Attacks attacks) {
+    while (any(pieces)) {
+        V from = lowest(pieces);
+        pieces = pieces ^ from;
+
+        V moves = attacks(from) & targets;
+        pseudo = pseudo + popcount(moves);
+
+        // A pinned piece stays on the line between king and pinner
+        for (int d = 0; d < 8; ++d) moves = moves & (lines[d] | isZero(pinned[d] & from));
+        legal = legal + popcount(moves);
+    }
+}
+
+template <typename V>
+void countLanes(const V (&board)[N_COLORS][N_PIECES], V white, V ep, V castling, V& pseudo,
+                V& legal) {
+    // Every position is played as white, blending in the side to move and
+    // mirroring the ranks where black moves
+    V us[N_PIECES], them[N_PIECES];
+    for (int p = ALL_PIECES; p < N_PIECES; ++p) {
+        us[p] = select(white, board[WHITE][p], byteswap(board[BLACK][p]));
+        them[p] = select(white, board[BLACK][p], byteswap(board[WHITE][p]));
+    }
+    ep = select(white, ep, byteswap(ep));
+    castling = select(white, castling, byteswap(castling)) & V::of(BB::RANK_MASK[RANK1]);
+
+    V zero = V::of(0), one = V::of(1);
+    V king = us[KING];
+    V occ = us[ALL_PIECES] | them[ALL_PIECES], empty = ~occ;
+    V diagonals = them[BISHOP] | them[QUEEN], straights = them[ROOK] | them[QUEEN];
+
+    // Enemy attacks see through our king, it can't step back along a ray
+    V danger = attackMap<false>(them, empty | king);
+
+    V checkers = (pawnAttacks<true>(king) & them[PAWN]) | (knightAttacks(king) & them[KNIGHT]);
+    V evasions = zero, pinned[8], lines[8];
+    kingRay<9>(king, empty, us[ALL_PIECES], diagonals, checkers, evasions, pinned[0], lines[0]);
+    kingRay<7>(king, empty, us[ALL_PIECES], diagonals, checkers, evasions, pinned[1], lines[1]);
+    kingRay<-7>(king, empty, us[ALL_PIECES], diagonals, checkers, evasions, pinned[2], lines[2]);
+    kingRay<-9>(king, empty, us[ALL_PIECES], diagonals, checkers, evasions, pinned[3], lines[3]);
+    kingRay<8>(king, empty, us[ALL_PIECES], straights, checkers, evasions, pinned[4], lines[4]);
+    kingRay<-8>(king, empty, us[ALL_PIECES], straights, checkers, evasions, pinned[5], lines[5]);
+    kingRay<1>(king, empty, us[ALL_PIECES], straights, checkers, evasions, pinned[6], lines[6]);
+    kingRay<-1>(king, empty, us[ALL_PIECES], straights, checkers, evasions, pinned[7], lines[7]);
+
+    // In check only captures of the checker or blocks, none in double check
+    V check = nonZero(checkers);
+    V doubleCheck = nonZero(checkers & (checkers - one));
+    V targets = select(check, andNot(doubleCheck, evasions | checkers), ~us[ALL_PIECES]);
+
+    pseudo = pawnMoves(us[PAWN], targets, empty, them[ALL_PIECES]);
+    V pins = zero;
+    for (int d = 0; d < 8; ++d) pins = pins | pinned[d];
+    legal = pawnMoves(andNot(pins, us[PAWN]), targets, empty, them[ALL_PIECES]);
+    for (int d = 0; d < 8; ++d) {
+        V pawns = us[PAWN] & pinned[d];
+        legal = legal + pawnMoves(pawns, targets & lines[d], empty, them[ALL_PIECES]);
+    }
+
+    // En passant, in check only when it takes the checker
+    ep = ep & nonZero(shift<-8>(ep) & targets);
+    V fromLeft = shift<-7>(ep) & V::of(NOT_A) & us[PAWN];
+    V fromRight = shift<-9>(ep) & V::of(NOT_H) & us[PAWN];
+    pseudo = pseudo + (nonZero(fromLeft) & one) + (nonZero(fromRight) & one);
+    legal = legal + (enPassantSafe(fromLeft, ep, king, occ, diagonals, straights) & one) +
+            (enPassantSafe(fromRight, ep, king, occ, diagonals, straights) & one);
+
+    pieceMoves(us[KNIGHT], targets, pinned, lines, pseudo, legal,
+               [](V b) { return knightAttacks(b); });
+    pieceMoves(us[BISHOP] | us[QUEEN], targets, pinned, lines, pseudo, legal,
+               [empty](V b) { return diagonal(b, empty); });
+    pieceMoves(us[ROOK] | us[QUEEN], targets, pinned, lines, pseudo, legal,
+               [empty](V b) { return straight(b, empty); });
+
+    V steps = andNot(us[ALL_PIECES], kingAttacks(king));
+    pseudo = pseudo + popcount(steps);
+    legal = legal + popcount(andNot(danger, steps));
+
+    // Castling never out of check, always legal once generated
+    V oo = nonZero(castling & V::of(BB::set(G1))) &
+           isZero(occ & V::of(BB::CastlePathOO[WHITE])) &
+           isZero(danger & V::of(BB::KingCastlePathOO[WHITE]));
+    V ooo = nonZero(castling & V::of(BB::set(C1))) &
+            isZero(occ & V::of(BB::CastlePathOOO[WHITE])) &
+            isZero(danger & V::of(BB::KingCastlePathOOO[WHITE]));
+    V castles = andNot(check, oo & one) + andNot(check, ooo & one);
+    pseudo = pseudo + castles;
+    legal = legal + castles;
+}
+
+}  // namespace
+
+// The kernels for any lane type, flattened into straight line code over it
+template <typename Lanes>
+[[gnu::flatten]] void BoardBatch::attacksWith(Color c, U64* out) const {
+    for (size_t i = 0; i < count; i += Lanes::N) {
+        Lanes own[N_PIECES];
+        for (int p = ALL_PIECES; p < N_PIECES; ++p) own[p] = Lanes::load(&pieces[c][p][i]);
+        Lanes empty = ~(own[ALL_PIECES] | Lanes::load(&pieces[~c][ALL_PIECES][i]));
+
+        U64 lanes[Lanes::N];
+        (c == WHITE ? attackMap<true>(own, empty) : attackMap<false>(own, empty)).store(lanes);
+        for (size_t j = 0; j < Lanes::N && i + j < count; ++j) out[i + j] = lanes[j];
+    }
+}
+
+template <typename Lanes>
+[[gnu::flatten]] void BoardBatch::countMovesWith(U32* pseudoLegal, U32* legal) const {
+    for (size_t i = 0; i < count; i += Lanes::N) {
+        Lanes board[N_COLORS][N_PIECES];
+        for (int c = BLACK; c < N_COLORS; ++c)
+            for (int p = ALL_PIECES; p < N_PIECES; ++p) board[c][p] = Lanes::load(&pieces[c][p][i]);
+
+        Lanes pseudoCounts, legalCounts;
+        countLanes(board, Lanes::load(&whiteToMove[i]), Lanes::load(&enPassant[i]),
+                   Lanes::load(&castling[i]), pseudoCounts, legalCounts);
+
+        U64 p[Lanes::N], l[Lanes::N];
+        pseudoCounts.store(p);
+        legalCounts.store(l);
+        for (size_t j = 0; j < Lanes::N && i + j < count; ++j) {
+            pseudoLegal[i + j] = p[j];
+            legal[i + j] = l[j];
+        }
+    }
+}
+
+// Only the AVX2 kernels are built for it, everything else runs on any
+// x86-64 and the kernels fall back to one position at a time without it
+#ifdef USE_AVX2
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+namespace {
+
+// Four positions per register
+struct Avx2 {
+    static constexpr size_t N = 4;
+    __m256i v;
+
+    static Avx2 load(const U64* p) {
+        return {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))};
+    }
+    static Avx2 of(U64 x) { return {_mm256_set1_epi64x(x)}; }
+    void store(U64* p) const { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+};
+
+inline Avx2 operator&(Avx2 a, Avx2 b) { return {_mm256_and_si256(a.v, b.v)}; }
+inline Avx2 operator|(Avx2 a, Avx2 b) { return {_mm256_or_si256(a.v, b.v)}; }
+inline Avx2 operator^(Avx2 a, Avx2 b) { return {_mm256_xor_si256(a.v, b.v)}; }
+inline Avx2 operator+(Avx2 a, Avx2 b) { return {_mm256_add_epi64(a.v, b.v)}; }
+inline Avx2 operator-(Avx2 a, Avx2 b) { return {_mm256_sub_epi64(a.v, b.v)}; }
+inline Avx2 operator~(Avx2 a) { return {_mm256_xor_si256(a.v, _mm256_set1_epi64x(-1))}; }
+inline Avx2 andNot(Avx2 a, Avx2 b) { return {_mm256_andnot_si256(a.v, b.v)}; }
+inline Avx2 isZero(Avx2 a) { return {_mm256_cmpeq_epi64(a.v, _mm256_setzero_si256())}; }
+inline bool any(Avx2 a) { return !_mm256_testz_si256(a.v, a.v); }
+
+inline Avx2 popcount(Avx2 a) {
+    // Nibble lookups summed per byte, then per 64 bit lane
+    // http://0x80.pl/articles/sse-popcount.html
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,  //
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(a.v, nibble));
+    __m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(a.v, 4), nibble));
+    return {_mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256())};
+}
+
+inline Avx2 byteswap(Avx2 a) {
+    const __m256i reverse = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                                             7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    return {_mm256_shuffle_epi8(a.v, reverse)};
+}
+
+template <int s>
+inline Avx2 shift(Avx2 a) {
+    if constexpr (s > 0)
+        return {_mm256_slli_epi64(a.v, s)};
+    else
+        return {_mm256_srli_epi64(a.v, -s)};
+}
+
+static_assert(BoardBatch::LANES % Avx2::N == 0);
+
+}  // namespace
+
+// Flattened so the generic kernels and BB::occludedFill, defined outside
+// this region, are inlined as AVX2 code rather than called per operation
+[[gnu::flatten]] void BoardBatch::attacksAvx2(Color c, U64* out) const {
+    attacksWith<Avx2>(c, out);
+}
+
+[[gnu::flatten]] void BoardBatch::countMovesAvx2(U32* pseudoLegal, U32* legal) const {
+    countMovesWith<Avx2>(pseudoLegal, legal);
+}
+
+#pragma GCC pop_options
+#endif
+
+void BoardBatch::attacks(Color c, U64* out) const {
+#ifdef USE_AVX2
+    if (vectorized()) return attacksAvx2(c, out);
+#endif
+    attacksWith<Scalar>(c, out);
+}
+
+void BoardBatch::countMoves(U32* pseudoLegal, U32* legal) const {
+#ifdef USE_AVX2
+    if (vectorized()) return countMovesAvx2(pseudoLegal, legal);
+#endif
+    countMovesWith<Scalar>(pseudoLegal, legal);
+}
+
+void BoardBatch::add(const Chess& chess) {
+    // Grow a register at a time, padding positions stay empty
+    if (count % LANES == 0) {
+        for (auto& side : pieces)
+            for (auto& bitboards : side) bitboards.resize(count + LANES);
+        whiteToMove.resize(count + LANES);
+        enPassant.resize(count + LANES);
+        castling.resize(count + LANES);
+    }
+
+    for (int c = BLACK; c < N_COLORS; ++c)
+        for (int p = ALL_PIECES; p < N_PIECES; ++p) pieces[c][p][count] = chess.board.pieces[c][p];
+
+    whiteToMove[count] = chess.turn == WHITE ? ~0ull : 0;
+
+    Square ep = chess.getEnPassant();
+    enPassant[count] = ep == INVALID ? 0 : BB::set(ep);
+
+    const State& state = chess.state.at(chess.ply);
+    U64 rights = 0;
+    for (Color c : {BLACK, WHITE}) {
+        if (state.canCastleOO(c)) rights |= BB::set(KingDestinationOO[c]);
+        if (state.canCastleOOO(c)) rights |= BB::set(KingDestinationOOO[c]);
+    }
+    castling[count] = rights;
+    ++count;
+}
+
+void BoardBatch::clear() {
+    count = 0;
+    for (auto& side : pieces)
+        for (auto& bitboards : side) bitboards.clear();
+    whiteToMove.clear();
+    enPassant.clear();
+    castling.clear();
+}
+
+bool BoardBatch::vectorized() {
+#ifdef USE_AVX2
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
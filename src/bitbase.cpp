@@ -0,0 +1,139 @@
+#include "bitbase.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+#include "bb.hpp"
+#include "defs.hpp"
+#include "threadpool.hpp"
+
+namespace Bitbases {
+
+namespace {
+
+// Win bits for each side to move, pawn square (files a-d, ranks 2-7) and
+// white king square, as a set of black king squares
+U64 kpk[N_COLORS][24][N_SQUARES];
+
+int pawnIndex(Square pawn) {
+    return (Defs::rankFromSq(pawn) - RANK2) * 4 + Defs::fileFromSq(pawn);
+}
+
+U64 (*const shifts[8])(U64) = {BB::shiftNorth,
+                               BB::shiftSouth,
+                               BB::shiftEast,
+                               BB::shiftWest,
+                               BB::shiftNorthEast,
+                               BB::shiftNorthWest,
+                               BB::shiftSouthEast,
+                               BB::shiftSouthWest};
+
+void solveFile(File file, U64 win[N_COLORS][N_SQUARES][N_SQUARES]) {
+    // Pawns only move up the file, so each rank is solved to a fixed point
+    // from the 7th down, reading the already solved ranks above it
+    for (int rank = RANK7; rank >= RANK2; --rank) {
+        Square pawn = Defs::sqFromCoords(file, Rank(rank));
+        Square push = Square(pawn + 8);
+        U64 pawnAttacks = BB::attacksByPawns<WHITE>(BB::set(pawn));
+
+        U64 validW[N_SQUARES], validB[N_SQUARES], legalB[N_SQUARES], promotes[N_SQUARES];
+        for (int wk = A1; wk < N_SQUARES; ++wk) {
+            U64 whiteKing = BB::KING_ATTACKS[wk] | BB::set(Square(wk));
+            bool onPawn = wk == pawn;
+
+            // Black king squares that make a legal position for each side to move
+            validB[wk] = onPawn ? 0 : ~(whiteKing | BB::set(pawn));
+            validW[wk] = validB[wk] & ~pawnAttacks;
+
+            // Where the black king may step, an undefended pawn can be taken
+            legalB[wk] = ~(whiteKing | pawnAttacks);
+
+            // Pawn on the 7th queens unless the black king takes it
+            promotes[wk] = 0;
+            if (rank == RANK7 && wk != push) {
+                U64 safe = BB::DISTANCE[wk][push] == 1 ? ~0ull
+                                                       : ~(BB::KING_ATTACKS[push] | BB::set(push));
+                promotes[wk] = validW[wk] & safe & ~BB::set(push);
+            }
+        }
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+
+            // Black to move loses if every legal king step loses, and it has one
+            for (int wk = A1; wk < N_SQUARES; ++wk) {
+                U64 good = win[WHITE][pawn][wk] | ~legalB[wk];
+                U64 allGood = ~0ull, hasMove = 0;
+                for (auto shift : shifts) {
+                    allGood &= shift(good) | ~shift(~0ull);
+                    hasMove |= shift(legalB[wk]);
+                }
+
+                U64 wins = validB[wk] & allGood & hasMove;
+                if (wins != win[BLACK][pawn][wk]) {
+                    win[BLACK][pawn][wk] = wins;
+                    changed = true;
+                }
+            }
+
+            // White to move wins if any king step or pawn push wins
+            for (int wk = A1; wk < N_SQUARES; ++wk) {
+                U64 wins = promotes[wk];
+
+                U64 moves = BB::KING_ATTACKS[wk];
+                while (moves) {
+                    Square to = BB::lsb(moves);
+                    moves &= BB::clear(to);
+                    wins |= win[BLACK][pawn][to];
+                }
+
+                if (rank < RANK7 && push != wk) {
+                    wins |= win[BLACK][push][wk];
+                    if (rank == RANK2) wins |= win[BLACK][push + 8][wk] & ~BB::set(push);
+                }
+
+                wins &= validW[wk];
+                if (wins != win[WHITE][pawn][wk]) {
+                    win[WHITE][pawn][wk] = wins;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+void init() {
+    // Full board scratch tables, each file only touches its own pawn squares
+    auto scratch = std::make_unique<U64[][N_SQUARES][N_SQUARES]>(N_COLORS);
+    auto win = scratch.get();
+
+    // Files are independent, solve them in parallel
+    ThreadPool pool(std::min(4u, std::thread::hardware_concurrency()));
+    for (int file = FILE1; file <= FILE4; ++file)
+        pool.submit([file, win] { solveFile(File(file), win); });
+    pool.wait();
+
+    for (Color c : {WHITE, BLACK}) {
+        for (int sq = A2; sq <= H7; ++sq) {
+            if (Defs::fileFromSq(Square(sq)) > FILE4) continue;
+            for (int wk = A1; wk < N_SQUARES; ++wk)
+                kpk[c][pawnIndex(Square(sq))][wk] = win[c][sq][wk];
+        }
+    }
+}
+
+bool probeKPK(Square whiteKing, Square pawn, Square blackKing, Color stm) {
+    // Mirror pawns on files e-h onto a-d
+    if (Defs::fileFromSq(pawn) > FILE4) {
+        whiteKing = Square(whiteKing ^ 7);
+        blackKing = Square(blackKing ^ 7);
+        pawn = Square(pawn ^ 7);
+    }
+    return kpk[stm][pawnIndex(pawn)][whiteKing] & BB::set(blackKing);
+}
+
+}  // namespace Bitbases
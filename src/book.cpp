@@ -0,0 +1,345 @@
+#include "book.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <map>
+
+#include "chess.hpp"
+#include "constants.hpp"
+#include "movegen.hpp"
+
+namespace Book {
+
+namespace {
+
+template <typename T>
+T readBigEndian(const U8* p) {
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) value = (value << 8) | p[i];
+    return value;
+}
+
+template <typename T>
+void writeBigEndian(std::ostream& os, T value) {
+    for (int i = sizeof(T) - 1; i >= 0; --i) os.put(char((value >> (8 * i)) & 0xFF));
+}
+
+std::vector<Move> legalMoves(Chess& chess) {
+    MoveGenerator movegen(&chess);
+    movegen.generatePseudoLegalMoves();
+
+    std::vector<Move> moves;
+    for (auto& move : movegen.moves) {
+        if (chess.isPseudoLegalMoveLegal(move)) moves.push_back(move);
+    }
+    return moves;
+}
+
+PieceType pieceFromChar(char c) {
+    switch (c) {
+        case 'N': return KNIGHT;
+        case 'B': return BISHOP;
+        case 'R': return ROOK;
+        case 'Q': return QUEEN;
+        case 'K': return KING;
+        default: return NO_PIECE_TYPE;
+    }
+}
+
+bool isResult(const std::string& token) {
+    return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+}  // namespace
+
+Reader::~Reader() { close(); }
+
+bool Reader::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd == -1 || fstat(fd, &st) == -1 || st.st_size < off_t(ENTRY_SIZE)) {
+        if (fd != -1) ::close(fd);
+        return false;
+    }
+
+    void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) return false;
+
+    data = static_cast<const U8*>(addr);
+    mapped = st.st_size;
+    bytes = mapped - mapped % ENTRY_SIZE;
+    return true;
+}
+
+void Reader::close() {
+    if (data) munmap(const_cast<U8*>(data), mapped);
+    data = nullptr;
+    mapped = 0;
+    bytes = 0;
+}
+
+Entry Reader::entryAt(size_t i) const {
+    const U8* p = data + i * ENTRY_SIZE;
+    return {readBigEndian<U64>(p), readBigEndian<U16>(p + 8), readBigEndian<U16>(p + 10),
+            readBigEndian<U32>(p + 12)};
+}
+
+std::vector<Entry> Reader::probe(U64 key) const {
+    // Binary search for the first entry of the key, the rest follow it
+    size_t lo = 0, hi = size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (readBigEndian<U64>(data + mid * ENTRY_SIZE) < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    std::vector<Entry> entries;
+    for (; lo < size(); ++lo) {
+        Entry entry = entryAt(lo);
+        if (entry.key != key) break;
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+Move Reader::pick(Chess& chess, bool best) {
+    // Choose a book move at random in proportion to its weight, or the
+    // heaviest one. Returns a null move when out of book.
+    if (!isOpen()) return Move();
+
+    std::vector<Entry> entries = probe(chess.calculatePolyglotKey());
+    std::vector<Move> moves;
+    std::vector<U32> weights;
+    for (auto& entry : entries) {
+        Move move = decodeMove(chess, entry.move);
+        if (move.isNullMove()) continue;
+        moves.push_back(move);
+        weights.push_back(entry.weight);
+    }
+    if (moves.empty()) return Move();
+
+    if (best) return moves[std::max_element(weights.begin(), weights.end()) - weights.begin()];
+
+    U32 total = 0;
+    for (auto weight : weights) total += weight;
+    if (total == 0) return moves[0];
+
+    U32 r = std::uniform_int_distribution<U32>(0, total - 1)(rng);
+    for (size_t i = 0; i < moves.size(); ++i) {
+        if (r < weights[i]) return moves[i];
+        r -= weights[i];
+    }
+    return moves.back();
+}
+
+U16 encodeMove(Move move) {
+    // | 14-12 | 11-9     | 8-6       | 5-3    | 2-0     |
+    // | promo | from row | from file | to row | to file |
+    Square from = move.from();
+    Square to = move.to();
+
+    // Castling is encoded as the king taking its own rook
+    if (move.type() == CASTLE) {
+        Color c = from == E1 ? WHITE : BLACK;
+        to = to == KingDestinationOO[c] ? RookOriginOO[c] : RookOriginOOO[c];
+    }
+
+    U16 promo = move.type() == PROMOTION ? move.promoPiece() - PAWN : 0;
+    return U16(to) | U16(from) << 6 | promo << 12;
+}
+
+Move decodeMove(Chess& chess, U16 value) {
+    // Only accept moves that are legal here, guarding against key collisions
+    value &= 0x7FFF;
+    for (auto& move : legalMoves(chess)) {
+        if (encodeMove(move) == value) return move;
+    }
+    return Move();
+}
+
+Move parseSAN(Chess& chess, const std::string& token) {
+    // Standard algebraic notation, e.g. e4, exd5, Nbd7, R1e2, e8=Q+, O-O
+    std::string san;
+    for (char c : token) {
+        if (c != '+' && c != '#' && c != '!' && c != '?') san += c;
+    }
+    if (san.empty()) return Move();
+
+    std::vector<Move> moves = legalMoves(chess);
+
+    if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+        bool kingside = san.size() == 3;
+        for (auto& move : moves) {
+            if (move.type() != CASTLE) continue;
+            bool oo = Defs::fileFromSq(move.to()) == FILE7;
+            if (oo == kingside) return move;
+        }
+        return Move();
+    }
+
+    PieceType piece = PAWN;
+    size_t begin = 0;
+    if (std::isupper(san[0])) {
+        piece = pieceFromChar(san[0]);
+        if (piece == NO_PIECE_TYPE) return Move();
+        begin = 1;
+    }
+
+    PieceType promo = NO_PIECE_TYPE;
+    size_t eq = san.find('=');
+    if (eq != std::string::npos && eq + 1 < san.size()) {
+        promo = pieceFromChar(san[eq + 1]);
+        san = san.substr(0, eq);
+    } else if (piece == PAWN && std::isupper(san.back())) {
+        promo = pieceFromChar(san.back());
+        san.pop_back();
+    }
+
+    if (san.size() < begin + 2) return Move();
+    std::string dest = san.substr(san.size() - 2);
+    if (dest[0] < 'a' || dest[0] > 'h' || dest[1] < '1' || dest[1] > '8') return Move();
+    Square to = Defs::sqFromString(dest);
+
+    // Whatever is left between piece and destination disambiguates
+    int fromFile = -1, fromRank = -1;
+    for (size_t i = begin; i + 2 < san.size(); ++i) {
+        if (san[i] >= 'a' && san[i] <= 'h') fromFile = san[i] - 'a';
+        if (san[i] >= '1' && san[i] <= '8') fromRank = san[i] - '1';
+    }
+
+    // Ambiguous moves are as unusable as illegal ones
+    Move match;
+    int matches = 0;
+    for (auto& move : moves) {
+        if (move.to() != to) continue;
+        if (Defs::getPieceType(chess.getPiece(move.from())) != piece) continue;
+        if (fromFile >= 0 && Defs::fileFromSq(move.from()) != fromFile) continue;
+        if (fromRank >= 0 && Defs::rankFromSq(move.from()) != fromRank) continue;
+        if (move.type() == PROMOTION ? move.promoPiece() != promo : promo != NO_PIECE_TYPE)
+            continue;
+        if (move.type() == CASTLE) continue;
+        match = move;
+        ++matches;
+    }
+    return matches == 1 ? match : Move();
+}
+
+std::vector<Entry> fromPGN(std::istream& is, int maxPly) {
+    // Every (position, move) of every game up to maxPly, weighted two points
+    // per win and one per draw for the side that played it
+    std::map<std::pair<U64, U16>, U32> scores;
+    std::string line, movetext;
+
+    auto addGame = [&](const std::string& text) {
+        std::vector<std::string> tokens;
+        std::string token;
+        int comment = 0, variation = 0;
+
+        for (size_t i = 0; i <= text.size(); ++i) {
+            char c = i < text.size() ? text[i] : ' ';
+            if (comment) {
+                if (c == '}') comment = 0;
+            } else if (c == '{') {
+                comment = 1;
+            } else if (c == '(') {
+                ++variation;
+            } else if (c == ')') {
+                if (variation) --variation;
+            } else if (variation) {
+                continue;
+            } else if (std::isspace(c)) {
+                if (!token.empty()) tokens.push_back(token);
+                token.clear();
+            } else {
+                token += c;
+            }
+        }
+
+        // The result closes the movetext
+        if (tokens.empty() || !isResult(tokens.back())) return;
+        std::string result = tokens.back();
+        tokens.pop_back();
+        if (result == "*") return;
+
+        Chess chess(STARTFEN);
+        int ply = 0;
+        for (auto& t : tokens) {
+            // Strip move numbers, "12." and "12..." possibly glued to the move
+            size_t start = t.find_first_not_of("0123456789.");
+            if (start == std::string::npos || t[0] == '$') continue;
+            std::string san = t.substr(start);
+            if (ply >= maxPly) break;
+
+            Move move = parseSAN(chess, san);
+            if (move.isNullMove()) break;
+
+            Color side = ply % 2 == 0 ? WHITE : BLACK;
+            U32 score = result == "1/2-1/2"                      ? 1
+                        : (result == "1-0") == (side == WHITE) ? 2
+                                                               : 0;
+            scores[{chess.calculatePolyglotKey(), encodeMove(move)}] += score;
+
+            chess.make(move);
+            ++ply;
+        }
+    };
+
+    while (std::getline(is, line)) {
+        // Strip line comments and carriage returns
+        size_t semicolon = line.find(';');
+        if (semicolon != std::string::npos) line = line.substr(0, semicolon);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        if (!line.empty() && line[0] == '[') {
+            // A tag after movetext starts the next game
+            if (!movetext.empty()) addGame(movetext);
+            movetext.clear();
+        } else {
+            movetext += line + " ";
+        }
+    }
+    if (!movetext.empty()) addGame(movetext);
+
+    std::vector<Entry> entries;
+    U32 maxScore = 0;
+    for (auto& [keyMove, score] : scores) maxScore = std::max(maxScore, score);
+
+    for (auto& [keyMove, score] : scores) {
+        // Moves that only ever lost stay out, the rest are scaled to 16 bits
+        if (score == 0) continue;
+        U32 weight = maxScore > 0xFFFF ? std::max<U64>(1, U64(score) * 0xFFFF / maxScore) : score;
+        entries.push_back({keyMove.first, keyMove.second, U16(weight), 0});
+    }
+
+    // Sorted by key, heaviest move first
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.key != b.key ? a.key < b.key : a.weight > b.weight;
+    });
+    return entries;
+}
+
+bool write(const std::string& path, const std::vector<Entry>& entries) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    for (auto& entry : entries) {
+        writeBigEndian(file, entry.key);
+        writeBigEndian(file, entry.move);
+        writeBigEndian(file, entry.weight);
+        writeBigEndian(file, entry.learn);
+    }
+    return bool(file);
+}
+
+}  // namespace Book
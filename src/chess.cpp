@@ -1,12 +1,14 @@
 #include "chess.hpp"
 
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+
 #include "defs.hpp"
 #include "eval.hpp"
-#include "fen.hpp"
 
-std::tuple<int, int> Chess::pawnsEval() const {
-    int mgScore = 0;
-    int egScore = 0;
+Score Chess::pawnsEval() const {
+    Score score = SCORE_ZERO;
 
     U64 wPawns = board.getPieces<PAWN>(WHITE);
     U64 bPawns = board.getPieces<PAWN>(BLACK);
@@ -16,42 +18,172 @@ std::tuple<int, int> Chess::pawnsEval() const {
     U64 wIsolatedPawns = Eval::isolatedPawns(wPawns);
     U64 bIsolatedPawns = Eval::isolatedPawns(bPawns);
     int nIsolatedPawns = BB::bitCount(wIsolatedPawns) - BB::bitCount(bIsolatedPawns);
-    mgScore += nIsolatedPawns * Eval::ISO_PAWN_PENALTY[MIDGAME];
-    egScore += nIsolatedPawns * Eval::ISO_PAWN_PENALTY[ENDGAME];
+    score += nIsolatedPawns * Eval::ISO_PAWN_PENALTY;
 
     // backwards pawns
     U64 wBackwardsPawns = Eval::backwardsPawns<WHITE, BLACK>(wPawns, bPawns);
     U64 bBackwardsPawns = Eval::backwardsPawns<BLACK, WHITE>(bPawns, wPawns);
     int nBackwardsPawns = BB::bitCount(wBackwardsPawns) - BB::bitCount(bBackwardsPawns);
-    mgScore += nBackwardsPawns * Eval::BACKWARD_PAWN_PENALTY[MIDGAME];
-    egScore += nBackwardsPawns * Eval::BACKWARD_PAWN_PENALTY[ENDGAME];
+    score += nBackwardsPawns * Eval::BACKWARD_PAWN_PENALTY;
 
     // doubled pawns
     U64 wDoubledPawns = Eval::doubledPawns<WHITE>(wPawns);
     U64 bDoubledPawns = Eval::doubledPawns<BLACK>(bPawns);
     int nDoubledPawns = BB::bitCount(wDoubledPawns) - BB::bitCount(bDoubledPawns);
-    mgScore += nDoubledPawns * Eval::DOUBLED_PAWN_PENALTY[MIDGAME];
-    egScore += nDoubledPawns * Eval::DOUBLED_PAWN_PENALTY[ENDGAME];
+    score += nDoubledPawns * Eval::DOUBLED_PAWN_PENALTY;
+
+    return score;
+}
+
+void Chess::initEvalInfo(Eval::EvalInfo& info) const {
+    // Seed the attack maps with pawn and king attacks, the remaining pieces
+    // are added by the single attack generation pass in piecesEval
+    U64 wPawns = board.getPieces<PAWN>(WHITE);
+    U64 bPawns = board.getPieces<PAWN>(BLACK);
+
+    for (Color c : {WHITE, BLACK}) {
+        Square king = board.getKingSq(c);
+        U64 pawnAttacks = BB::attacksByPawns(board.getPieces<PAWN>(c), c);
+        U64 kingAttacks = BB::movesByPiece<KING>(king);
+
+        info.attackedBy[c][PAWN] = pawnAttacks;
+        info.attackedBy[c][KING] = kingAttacks;
+        info.attackedBy[c][ALL_PIECES] = pawnAttacks | kingAttacks;
+        info.attackedBy2[c] = pawnAttacks & kingAttacks;
+        info.kingZone[c] = kingAttacks | BB::set(king);
+    }
+
+    // Squares attacked by enemy pawns or occupied by our own pawns and king
+    // don't count towards mobility
+    for (Color c : {WHITE, BLACK}) {
+        info.mobilityArea[c] = ~(board.getPieces<PAWN>(c) | BB::set(board.getKingSq(c)) |
+                                 info.attackedBy[~c][PAWN]);
+    }
+
+    info.outposts[WHITE] = Eval::outposts<WHITE, BLACK>(wPawns, bPawns);
+    info.outposts[BLACK] = Eval::outposts<BLACK, WHITE>(bPawns, wPawns);
+}
+
+template <Color c, PieceType p>
+Score Chess::piecesEval(Eval::EvalInfo& info) const {
+    Score score = SCORE_ZERO;
+
+    Color enemy = ~c;
+    U64 occ = board.occupancy();
+    U64 bitboard = board.getPieces<p>(c);
+
+    while (bitboard) {
+        // Pop lsb bit and clear it from the bitboard
+        Square sq = BB::lsb(bitboard);
+        bitboard &= BB::clear(sq);
+
+        // Generate attacks once, every term below shares the lookup
+        U64 attacks = BB::movesByPiece<p>(sq, occ);
+        info.attackedBy2[c] |= info.attackedBy[c][ALL_PIECES] & attacks;
+        info.attackedBy[c][p] |= attacks;
+        info.attackedBy[c][ALL_PIECES] |= attacks;
+
+        // king zone attacks
+        if (attacks & info.kingZone[enemy]) {
+            info.kingAttackersCount[c]++;
+            info.kingAttackersWeight[c] += Eval::KING_ATTACK_WEIGHT[p];
+            info.kingAttacksCount[c] += BB::bitCount(attacks & info.attackedBy[enemy][KING]);
+        }
+
+        // mobility
+        int mobility = BB::bitCount(attacks & info.mobilityArea[c]);
+        score += Eval::mobilityBonus[p][mobility];
+
+        // minor pieces on or able to reach an outpost
+        if constexpr (p == KNIGHT || p == BISHOP) {
+            if (info.outposts[c] & BB::set(sq)) {
+                score += (p == KNIGHT) ? Eval::KNIGHT_OUTPOST_BONUS : Eval::BISHOP_OUTPOST_BONUS;
+            } else if (attacks & info.outposts[c] & ~board.getPieces<ALL_PIECES>(c)) {
+                score += Eval::REACHABLE_OUTPOST_BONUS;
+            }
+        }
+
+        // rooks on open and semi-open files
+        if constexpr (p == ROOK) {
+            U64 file = BB::FILE_MASK[Defs::fileFromSq(sq)];
+            if (!(file & board.getPieces<PAWN>(c))) {
+                bool open = !(file & board.getPieces<PAWN>(enemy));
+                score += open ? Eval::ROOK_OPEN_FILE_BONUS : Eval::ROOK_SEMIOPEN_FILE_BONUS;
+            }
+        }
+    }
+
+    return score;
+}
 
-    return std::make_tuple(mgScore, egScore);
+Score Chess::piecesEval(Eval::EvalInfo& info) const {
+    return piecesEval<WHITE, KNIGHT>(info) - piecesEval<BLACK, KNIGHT>(info) +
+           piecesEval<WHITE, BISHOP>(info) - piecesEval<BLACK, BISHOP>(info) +
+           piecesEval<WHITE, ROOK>(info) - piecesEval<BLACK, ROOK>(info) +
+           piecesEval<WHITE, QUEEN>(info) - piecesEval<BLACK, QUEEN>(info);
+}
+
+template <Color c>
+Score Chess::kingEval(const Eval::EvalInfo& info) const {
+    Score score = SCORE_ZERO;
+
+    Color enemy = ~c;
+    Square king = board.getKingSq(c);
+
+    // pawn shield
+    U64 shield = BB::kingShield<c>(king) & board.getPieces<PAWN>(c);
+    score += BB::bitCount(shield) * Eval::KING_SHIELD_BONUS;
+
+    // king danger, once enough enemy pieces attack the king zone
+    bool enemyQueen = board.count<QUEEN>(enemy) > 0;
+    if (info.kingAttackersCount[enemy] > 1 - enemyQueen) {
+        // attacked squares defended at most once, and only by our king
+        U64 weak = info.attackedBy[enemy][ALL_PIECES] & ~info.attackedBy2[c] &
+                   (~info.attackedBy[c][ALL_PIECES] | info.attackedBy[c][KING]);
+        int danger = Eval::kingDanger(info, c, weak, enemyQueen);
+
+        if (danger > Eval::KING_DANGER_THRESHOLD) {
+            score -= makeScore(danger * danger / 4096, danger / 16);
+        }
+    }
+
+    return score;
+}
+
+Score Chess::kingEval(const Eval::EvalInfo& info) const {
+    return kingEval<WHITE>(info) - kingEval<BLACK>(info);
 }
 
 template <bool debug = false>
 int Chess::eval() const {
-    auto [mgPawns, egPawns] = pawnsEval();
-    auto [mgPieces, egPieces] = pawnsEval();
+    const Material::Entry* material = Material::table.probe(board);
+
+    // known endgames are scored by their own evaluator
+    if (material->evaluator) {
+        int score = material->evaluator(board, material->strongSide, turn);
+        return score * ((2 * turn) - 1);
+    }
+
+    Eval::EvalInfo info;
+    initEvalInfo(info);
 
-    int mg = phaseEval<MIDGAME>(mgPawns, mgPieces);
-    int eg = phaseEval<ENDGAME>(egPawns, egPieces);
+    Score pawns = pawnsEval();
+    Score pieces = piecesEval(info);
+    Score king = kingEval(info);
+
+    int mg = phaseEval<MIDGAME>(pawns + pieces + king);
+    int eg = phaseEval<ENDGAME>(pawns + pieces + king);
 
     // tapered eval based on remaining non pawn material
-    int npm = board.nonPawnMaterial(WHITE) + board.nonPawnMaterial(BLACK);
-    int score = Eval::taperScore(mg, eg, Eval::calculatePhase(npm));
+    int score = Eval::taperScore(mg, eg, material->phase);
 
     // tempo bonus
     score += Eval::tempoBonus(turn);
 
     if constexpr (debug) {
+        std::cout << "pawns: " << mgValue(pawns) << " " << egValue(pawns) << std::endl;
+        std::cout << "pieces: " << mgValue(pieces) << " " << egValue(pieces) << std::endl;
+        std::cout << "king: " << mgValue(king) << " " << egValue(king) << std::endl;
         std::cout << "score: " << score << std::endl;
     }
 
@@ -63,35 +195,15 @@ template int Chess::eval<true>() const;
 template int Chess::eval<false>() const;
 
 int Chess::scaleFactor() const {
-    Color enemy = ~turn;
-    int pawnCount = board.count<PAWN>(turn);
-    int pawnCountEnemy = board.count<PAWN>(enemy);
-    int nonPawnMat = board.nonPawnMaterial(turn);
-    int nonPawnMatEnemy = board.nonPawnMaterial(enemy);
-    int nonPawnMatDiff = std::abs(nonPawnMat - nonPawnMatEnemy);
-
-    // Check for drawish scenarios with no pawns and equal material
-    if (pawnCount == 0 && pawnCountEnemy == 0 && nonPawnMatDiff <= Eval::mgPieceValue(BISHOP)) {
-        return nonPawnMat < Eval::mgPieceValue(ROOK) ? 0 : 16;
-    }
+    const Material::Entry* material = Material::table.probe(board);
 
     // Opposite-colored bishops often lead to draws
-    if (board.oppositeBishopsEndGame()) {
+    if (material->oppositeBishops && board.oppositeBishopsEndGame()) {
         // todo: use candidate passed pawns
         return std::min(64, 36 + 4 * BB::bitCount(board.passedPawns(turn)));
     }
 
-    // Single queen scenarios with minor pieces
-    int queenCount = board.count<QUEEN>(turn);
-    if (queenCount + board.count<QUEEN>(enemy) == 1) {
-        int minorPieceCount = queenCount == 1
-                                  ? board.count<BISHOP>(enemy) + board.count<KNIGHT>(enemy)
-                                  : board.count<BISHOP>(turn) + board.count<KNIGHT>(turn);
-        return std::min(64, 36 + 4 * minorPieceCount);
-    }
-
-    // Default: scale proportionally with pawns
-    return std::min(64, 36 + 5 * pawnCount);
+    return material->scale[turn];
 }
 
 void Chess::make(Move mv) {
@@ -212,6 +324,7 @@ void Chess::makeNull() {
     ++ply;
 
     state[ply].zkey ^= Zobrist::stm;
+    state[ply].pliesFromNull = 0;
     if (epsq != INVALID) {
         state[ply].zkey ^= Zobrist::ep[Defs::fileFromSq(epsq)];
     }
@@ -330,78 +443,198 @@ bool Chess::isCheckingMove(Move mv) const {
     return false;
 }
 
-Chess::Chess(const std::string& fen) : state{{State()}}, board{Board()}, ply{0}, moveCounter{0} {
-    FenParser parser(fen);
-
-    auto piece_placement = parser.getPiecePlacement();
-    for (auto piece = piece_placement.begin(); piece != piece_placement.end(); ++piece) {
-        addPiece<true>(piece->square, piece->color, piece->role);
-
-        if (piece->role == KING) {
-            board.kingSq[piece->color] = piece->square;
+bool Chess::isRepetition(int searchPly) const {
+    // A position can only repeat since the last irreversible move or null
+    // move, with the same side to move, so every other ply back to it
+    int end = std::min<int>(state.at(ply).hmClock, state.at(ply).pliesFromNull);
+    U64 key = state.at(ply).zkey;
+    int count = 0;
+
+    for (int i = 4; i <= end; i += 2) {
+        if (state.at(ply - i).zkey == key) {
+            // Once inside the search tree is enough, before the root the
+            // position has to be on the board for the third time
+            if (i < searchPly || ++count == 2) return true;
         }
     }
+    return false;
+}
 
-    turn = parser.getActiveColor();
-    state.at(ply).castle = parser.getCastlingRights();
-    state.at(ply).enPassantSq = parser.getEnPassantTarget();
-    state.at(ply).hmClock = parser.getHalfmoveClock();
-    moveCounter = parser.getFullmoveNumber();
+bool Chess::isDraw(int searchPly) const {
+    // Fifty move rule, unless mated on the last move which is left to search
+    if (state.at(ply).hmClock >= 100 && !isCheck()) return true;
 
-    state.at(ply).zkey = calculateKey();
-    updateState();
+    return isRepetition(searchPly);
 }
 
-std::string Chess::toFEN() const {
-    std::ostringstream oss;
+bool Chess::hasUpcomingRepetition(int searchPly) const {
+    // Whether the side to move has a reversible move back into a position
+    // of the search tree, found by looking up the key difference to each
+    // earlier position in the cuckoo table
+    int end = std::min<int>(state.at(ply).hmClock, state.at(ply).pliesFromNull);
+    if (end < 3) return false;
 
-    for (Rank rank = RANK8; rank >= RANK1; rank--) {
-        int emptyCount = 0;
-        for (File file = FILE1; file <= FILE8; file++) {
-            Piece p = board.getPiece(Defs::sqFromCoords(file, rank));
-            if (p != NO_PIECE) {
-                if (emptyCount > 0) {
-                    oss << emptyCount;
-                    emptyCount = 0;
-                }
-                oss << p;
-            } else {
-                ++emptyCount;
-            }
+    U64 key = state.at(ply).zkey;
+    U64 occ = board.occupancy();
+
+    for (int i = 3; i <= end; i += 2) {
+        U64 moveKey = key ^ state.at(ply - i).zkey;
+
+        int j = Zobrist::cuckooH1(moveKey);
+        if (Zobrist::cuckoo[j] != moveKey) {
+            j = Zobrist::cuckooH2(moveKey);
+            if (Zobrist::cuckoo[j] != moveKey) continue;
         }
 
-        if (emptyCount > 0) {
-            oss << emptyCount;
-            emptyCount = 0;
+        // The move must be playable, only repetitions after the root count
+        Move move = Zobrist::cuckooMove[j];
+        if (!(BB::bitsBtwn(move.from(), move.to()) & occ) && i < searchPly) return true;
+    }
+    return false;
+}
+
+Chess::Chess(const std::string& fen) : board{Board()} {
+    if (!setFromFEN(fen)) throw std::invalid_argument("Invalid FEN: " + fen);
+}
+
+bool Chess::setFromFEN(std::string_view fen) {
+    // One pass over the string straight into this position. The state
+    // vector keeps its capacity, and the key is built up piece by piece.
+    board = Board();
+    psq = SCORE_ZERO;
+    ply = 0;
+    state.resize(1);
+    state[0] = State();
+    State& st = state[0];
+
+    size_t i = 0;
+    auto field = [&]() {
+        while (i < fen.size() && fen[i] == ' ') ++i;
+        size_t begin = i;
+        while (i < fen.size() && fen[i] != ' ') ++i;
+        return fen.substr(begin, i - begin);
+    };
+
+    // Piece placement from a8 to h1, rank by rank
+    constexpr std::string_view PIECES = "pnbrqk";
+    int file = 0, rank = 7;
+    for (char ch : field()) {
+        if (ch == '/') {
+            file = 0;
+            if (--rank < 0) return false;
+        } else if (ch >= '1' && ch <= '8') {
+            file += ch - '0';
+        } else {
+            size_t index = PIECES.find(ch | 0x20);
+            if (index == std::string_view::npos || file > 7) return false;
+
+            Color c = ch < 'a' ? WHITE : BLACK;
+            PieceType pt = PieceType(PAWN + index);
+            Square sq = Square(8 * rank + file++);
+            addPiece<true>(sq, c, pt);
+            if (pt == KING) board.kingSq[c] = sq;
         }
-        if (rank != RANK1) oss << '/';
     }
 
-    if (turn) {
-        oss << " w ";
-    } else {
-        oss << " b ";
+    auto side = field();
+    if (side != "w" && side != "b") return false;
+    turn = side == "w" ? WHITE : BLACK;
+
+    auto castling = field();
+    if (castling.empty()) return false;
+    st.castle = NO_CASTLE;
+    for (char ch : castling) {
+        switch (ch) {
+            case 'K': st.castle |= WHITE_OO; break;
+            case 'Q': st.castle |= WHITE_OOO; break;
+            case 'k': st.castle |= BLACK_OO; break;
+            case 'q': st.castle |= BLACK_OOO; break;
+        }
     }
 
-    if (state.at(ply).canCastle(WHITE) || state.at(ply).canCastle(BLACK)) {
-        if (state.at(ply).canCastleOO(WHITE)) oss << "K";
-        if (state.at(ply).canCastleOOO(WHITE)) oss << "Q";
-        if (state.at(ply).canCastleOO(BLACK)) oss << "k";
-        if (state.at(ply).canCastleOOO(BLACK)) oss << "q";
-    } else {
-        oss << "-";
+    auto enpassant = field();
+    if (enpassant.empty()) return false;
+    if (enpassant != "-") {
+        if (enpassant.size() != 2 || enpassant[0] < 'a' || enpassant[0] > 'h' ||
+            enpassant[1] < '1' || enpassant[1] > '8')
+            return false;
+        st.enPassantSq = Square((enpassant[0] - 'a') + 8 * (enpassant[1] - '1'));
+    }
+
+    // The clocks are optional, EPD leaves them out
+    auto halfmove = field();
+    unsigned hmClock = 0;
+    std::from_chars(halfmove.data(), halfmove.data() + halfmove.size(), hmClock);
+    st.hmClock = hmClock;
+
+    auto fullmove = field();
+    moveCounter = 0;
+    if (!fullmove.empty()) {
+        U32 number = 0;
+        std::from_chars(fullmove.data(), fullmove.data() + fullmove.size(), number);
+        moveCounter = 2 * (number - 1) + (turn == WHITE ? 0 : 1);
+    }
+
+    if (turn == BLACK) st.zkey ^= Zobrist::stm;
+    if (st.canCastleOO(WHITE)) st.zkey ^= Zobrist::castle[WHITE][KINGSIDE];
+    if (st.canCastleOOO(WHITE)) st.zkey ^= Zobrist::castle[WHITE][QUEENSIDE];
+    if (st.canCastleOO(BLACK)) st.zkey ^= Zobrist::castle[BLACK][KINGSIDE];
+    if (st.canCastleOOO(BLACK)) st.zkey ^= Zobrist::castle[BLACK][QUEENSIDE];
+    if (st.enPassantSq != INVALID) st.zkey ^= Zobrist::ep[Defs::fileFromSq(st.enPassantSq)];
+
+    updateState();
+    return true;
+}
+
+char* Chess::toFEN(char* out) const {
+    // Writes at most MAX_FEN chars, no terminating null, returns the end
+    constexpr char PIECES[] = " pnbrqk  PNBRQK ";
+
+    for (int rank = 7; rank >= 0; rank--) {
+        int empty = 0;
+        for (int file = 0; file < 8; file++) {
+            Piece p = board.getPiece(Square(8 * rank + file));
+            if (p == NO_PIECE) {
+                ++empty;
+                continue;
+            }
+            if (empty) *out++ = '0' + empty;
+            empty = 0;
+            *out++ = PIECES[p];
+        }
+        if (empty) *out++ = '0' + empty;
+        if (rank) *out++ = '/';
     }
 
+    *out++ = ' ';
+    *out++ = turn == WHITE ? 'w' : 'b';
+    *out++ = ' ';
+
+    const State& st = state.at(ply);
+    if (!st.canCastle(WHITE) && !st.canCastle(BLACK)) *out++ = '-';
+    if (st.canCastleOO(WHITE)) *out++ = 'K';
+    if (st.canCastleOOO(WHITE)) *out++ = 'Q';
+    if (st.canCastleOO(BLACK)) *out++ = 'k';
+    if (st.canCastleOOO(BLACK)) *out++ = 'q';
+    *out++ = ' ';
+
     Square enpassant = getEnPassant();
     if (enpassant != INVALID) {
-        oss << " " << enpassant << " ";
+        *out++ = 'a' + Defs::fileFromSq(enpassant);
+        *out++ = '1' + Defs::rankFromSq(enpassant);
     } else {
-        oss << " - ";
+        *out++ = '-';
     }
 
-    oss << +state.at(ply).hmClock << " " << (moveCounter / 2) + 1;
+    *out++ = ' ';
+    out = std::to_chars(out, out + 3, unsigned(st.hmClock)).ptr;
+    *out++ = ' ';
+    return std::to_chars(out, out + 10, moveCounter / 2 + 1).ptr;
+}
 
-    return oss.str();
+std::string Chess::toFEN() const {
+    char buffer[MAX_FEN];
+    return std::string(buffer, toFEN(buffer));
 }
 
 std::string Chess::DebugString() const {
@@ -0,0 +1,69 @@
+#include "endgame.hpp"
+
+#include "bitbase.hpp"
+#include "eval.hpp"
+
+namespace Endgame {
+
+int KXK(const Board& board, Color strong, Color) {
+    // Drive the lone king to the edge and bring the winning king closer
+    Color weak = ~strong;
+    Square strongKing = board.getKingSq(strong);
+    Square weakKing = board.getKingSq(weak);
+
+    int score = board.nonPawnMaterial(strong) +
+                board.count<PAWN>(strong) * Eval::egPieceValue(PAWN) +
+                pushToEdge(weakKing) + pushClose(strongKing, weakKing);
+
+    U64 bishops = board.getPieces<BISHOP>(strong);
+    bool canMate = board.count<QUEEN>(strong) || board.count<ROOK>(strong) ||
+                   (board.count<BISHOP>(strong) && board.count<KNIGHT>(strong)) ||
+                   ((bishops & Eval::WHITESQUARES) && (bishops & Eval::BLACKSQUARES)) ||
+                   board.count<KNIGHT>(strong) > 2;
+
+    // Two knights or bishops on one color can't force mate, without a pawn
+    // to promote that's a draw
+    if (!canMate && !board.count<PAWN>(strong)) return 0;
+    if (canMate) score += KNOWN_WIN;
+
+    return strong == WHITE ? score : -score;
+}
+
+int KBNK(const Board& board, Color strong, Color) {
+    // Mate is only possible in a corner the bishop controls
+    Color weak = ~strong;
+    Square strongKing = board.getKingSq(strong);
+    Square weakKing = board.getKingSq(weak);
+
+    // pushToCorner favors a1/h8, mirror the file for a light squared bishop
+    Square target = weakKing;
+    if (board.getPieces<BISHOP>(strong) & Eval::WHITESQUARES)
+        target = Defs::sqFromCoords(File(FILE8 - Defs::fileFromSq(weakKing)),
+                                    Defs::rankFromSq(weakKing));
+
+    int score = KNOWN_WIN + Eval::mgPieceValue(BISHOP) + Eval::mgPieceValue(KNIGHT) +
+                pushClose(strongKing, weakKing) + 420 * pushToCorner(target);
+
+    return strong == WHITE ? score : -score;
+}
+
+int KPK(const Board& board, Color strong, Color stm) {
+    // Exact result from the bitbase, probed with white holding the pawn
+    Square strongKing = board.getKingSq(strong);
+    Square weakKing = board.getKingSq(~strong);
+    Square pawn = BB::lsb(board.getPieces<PAWN>(strong));
+
+    if (strong == BLACK) {
+        strongKing = Square(strongKing ^ 56);
+        weakKing = Square(weakKing ^ 56);
+        pawn = Square(pawn ^ 56);
+        stm = ~stm;
+    }
+
+    if (!Bitbases::probeKPK(strongKing, pawn, weakKing, stm)) return 0;
+
+    int score = KNOWN_WIN + Eval::egPieceValue(PAWN) + 10 * Defs::rankFromSq(pawn);
+    return strong == WHITE ? score : -score;
+}
+
+}  // namespace Endgame
@@ -0,0 +1,117 @@
+#include "epd.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+
+#include "book.hpp"
+#include "chess.hpp"
+#include "threadpool.hpp"
+
+namespace EPD {
+
+bool parse(const std::string& line, Position& pos) {
+    // Four FEN fields, then "opcode operand...;" operations
+    std::istringstream iss(line);
+    std::string fields[4];
+    for (auto& field : fields) {
+        if (!(iss >> field)) return false;
+    }
+    pos = Position();
+    pos.fen = fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3] + " 0 1";
+
+    std::string rest;
+    std::getline(iss, rest);
+    std::istringstream ops(rest);
+    std::string op;
+    while (std::getline(ops, op, ';')) {
+        std::istringstream opss(op);
+        std::string opcode, operand;
+        if (!(opss >> opcode)) continue;
+
+        std::vector<std::string> operands;
+        while (opss >> operand) operands.push_back(operand);
+
+        if (opcode == "bm")
+            pos.bestMoves = operands;
+        else if (opcode == "am")
+            pos.avoidMoves = operands;
+        else if (opcode == "id" && !operands.empty()) {
+            // Quoted string operand
+            size_t begin = op.find('"'), end = op.rfind('"');
+            pos.id = begin < end ? op.substr(begin + 1, end - begin - 1) : operands[0];
+        }
+    }
+    return true;
+}
+
+std::vector<Position> load(std::istream& is) {
+    std::vector<Position> positions;
+    std::string line;
+    Position pos;
+    while (std::getline(is, line)) {
+        if (parse(line, pos)) positions.push_back(pos);
+    }
+    return positions;
+}
+
+Result solve(const Position& pos, Chess& chess, Search& search, const SearchLimits& limits) {
+    // A malformed FEN is skipped rather than taking down the whole run
+    Result result;
+    if (!chess.setFromFEN(pos.fen)) {
+        result.skipped = true;
+        return result;
+    }
+
+    // Search from clean tables so results don't depend on scheduling
+    search.newGame();
+    search.think(limits);
+
+    result.move = search.bestMove;
+    result.score = search.bestScore;
+    result.nodes = search.getNodes();
+
+    // Solved if among the best moves and not among the moves to avoid
+    auto matches = [&](const std::vector<std::string>& sans) {
+        for (auto& san : sans) {
+            if (Book::parseSAN(chess, san) == result.move) return true;
+        }
+        return false;
+    };
+    result.solved = !result.move.isNullMove() && !matches(pos.avoidMoves) &&
+                    (pos.bestMoves.empty() || matches(pos.bestMoves));
+    return result;
+}
+
+Report run(const std::vector<Position>& positions, const SearchLimits& limits, size_t threads) {
+    Report report;
+    report.results.resize(positions.size());
+    auto start = std::chrono::steady_clock::now();
+
+    // Each worker keeps one Chess and Search and pulls the next position
+    // off a shared counter, so long searches don't hold up a whole chunk
+    ThreadPool pool(threads);
+    std::atomic<size_t> next = 0;
+    for (size_t i = 0; i < pool.size(); ++i) {
+        pool.submit([&] {
+            Chess chess(STARTFEN);
+            Search search(&chess);
+            search.silent = true;
+
+            for (size_t j = next++; j < positions.size(); j = next++)
+                report.results[j] = solve(positions[j], chess, search, limits);
+        });
+    }
+    pool.wait();
+
+    for (auto& result : report.results) {
+        report.solved += result.solved;
+        report.skipped += result.skipped;
+        report.nodes += result.nodes;
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+}  // namespace EPD
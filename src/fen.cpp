@@ -19,7 +19,7 @@ void FenParser::parse() {
     if (sections.size() > 5)  parseFullmove(sections.at(5), active_color_);
 }
 
-std::vector<PieceSquare> FenParser::getPiecePlacement() const { return piece_placement_; }
+const std::vector<PieceSquare>& FenParser::getPiecePlacement() const { return piece_placement_; }
 Color FenParser::getActiveColor() const { return active_color_; }
 CastleRights FenParser::getCastlingRights() const { return castling_rights_; }
 Square FenParser::getEnPassantTarget() const { return en_passant_target_; }
@@ -1,6 +1,5 @@
 #include "magics.hpp"
 
-#include "bb.hpp"
 #include "types.hpp"
 
 /**
@@ -32,196 +31,102 @@
  */
 
 namespace Magics {
-U64 rookAttacksDB[102400];
-U64 bishopAttacksDB[5248];
-
-void init() {
-  U64* rookAttacksInit[64] = {
-      rookAttacksDB + 86016, rookAttacksDB + 73728, rookAttacksDB + 36864,
-      rookAttacksDB + 43008, rookAttacksDB + 47104, rookAttacksDB + 51200,
-      rookAttacksDB + 77824, rookAttacksDB + 94208, rookAttacksDB + 69632,
-      rookAttacksDB + 32768, rookAttacksDB + 38912, rookAttacksDB + 10240,
-      rookAttacksDB + 14336, rookAttacksDB + 53248, rookAttacksDB + 57344,
-      rookAttacksDB + 81920, rookAttacksDB + 24576, rookAttacksDB + 33792,
-      rookAttacksDB + 6144,  rookAttacksDB + 11264, rookAttacksDB + 15360,
-      rookAttacksDB + 18432, rookAttacksDB + 58368, rookAttacksDB + 61440,
-      rookAttacksDB + 26624, rookAttacksDB + 4096,  rookAttacksDB + 7168,
-      rookAttacksDB + 0,     rookAttacksDB + 2048,  rookAttacksDB + 19456,
-      rookAttacksDB + 22528, rookAttacksDB + 63488, rookAttacksDB + 28672,
-      rookAttacksDB + 5120,  rookAttacksDB + 8192,  rookAttacksDB + 1024,
-      rookAttacksDB + 3072,  rookAttacksDB + 20480, rookAttacksDB + 23552,
-      rookAttacksDB + 65536, rookAttacksDB + 30720, rookAttacksDB + 34816,
-      rookAttacksDB + 9216,  rookAttacksDB + 12288, rookAttacksDB + 16384,
-      rookAttacksDB + 21504, rookAttacksDB + 59392, rookAttacksDB + 67584,
-      rookAttacksDB + 71680, rookAttacksDB + 35840, rookAttacksDB + 39936,
-      rookAttacksDB + 13312, rookAttacksDB + 17408, rookAttacksDB + 54272,
-      rookAttacksDB + 60416, rookAttacksDB + 83968, rookAttacksDB + 90112,
-      rookAttacksDB + 75776, rookAttacksDB + 40960, rookAttacksDB + 45056,
-      rookAttacksDB + 49152, rookAttacksDB + 55296, rookAttacksDB + 79872,
-      rookAttacksDB + 98304};
-  U64* bishopAttacksInit[64] = {
-      bishopAttacksDB + 4992, bishopAttacksDB + 2624, bishopAttacksDB + 256,
-      bishopAttacksDB + 896,  bishopAttacksDB + 1280, bishopAttacksDB + 1664,
-      bishopAttacksDB + 4800, bishopAttacksDB + 5120, bishopAttacksDB + 2560,
-      bishopAttacksDB + 2656, bishopAttacksDB + 288,  bishopAttacksDB + 928,
-      bishopAttacksDB + 1312, bishopAttacksDB + 1696, bishopAttacksDB + 4832,
-      bishopAttacksDB + 4928, bishopAttacksDB + 0,    bishopAttacksDB + 128,
-      bishopAttacksDB + 320,  bishopAttacksDB + 960,  bishopAttacksDB + 1344,
-      bishopAttacksDB + 1728, bishopAttacksDB + 2304, bishopAttacksDB + 2432,
-      bishopAttacksDB + 32,   bishopAttacksDB + 160,  bishopAttacksDB + 448,
-      bishopAttacksDB + 2752, bishopAttacksDB + 3776, bishopAttacksDB + 1856,
-      bishopAttacksDB + 2336, bishopAttacksDB + 2464, bishopAttacksDB + 64,
-      bishopAttacksDB + 192,  bishopAttacksDB + 576,  bishopAttacksDB + 3264,
-      bishopAttacksDB + 4288, bishopAttacksDB + 1984, bishopAttacksDB + 2368,
-      bishopAttacksDB + 2496, bishopAttacksDB + 96,   bishopAttacksDB + 224,
-      bishopAttacksDB + 704,  bishopAttacksDB + 1088, bishopAttacksDB + 1472,
-      bishopAttacksDB + 2112, bishopAttacksDB + 2400, bishopAttacksDB + 2528,
-      bishopAttacksDB + 2592, bishopAttacksDB + 2688, bishopAttacksDB + 832,
-      bishopAttacksDB + 1216, bishopAttacksDB + 1600, bishopAttacksDB + 2240,
-      bishopAttacksDB + 4864, bishopAttacksDB + 4960, bishopAttacksDB + 5056,
-      bishopAttacksDB + 2720, bishopAttacksDB + 864,  bishopAttacksDB + 1248,
-      bishopAttacksDB + 1632, bishopAttacksDB + 2272, bishopAttacksDB + 4896,
-      bishopAttacksDB + 5184};
-
-  // Pre-calculate bishop attacks with magic bitboards
-  for (int i = 0; i < 64; i++) {
-    int squares[64];
-    int numsquares = 0;
-    U64 temp = bishopMagicMask[i];
-
-    while (temp) {
-      U64 bitboard = temp & -temp;
-      squares[numsquares++] = BB::lsb(bitboard);
-      temp ^= bitboard;
-    }
-    for (temp = 0; temp < (U64)1 << numsquares; temp++) {
-      U64 moves;
-      U64 tempoccupied = initOccupied(squares, numsquares, temp);
-      moves = initMagicBishop(i, tempoccupied);
-      *(bishopAttacksInit[i] +
-        (tempoccupied * bishopMagicNum[i] >> bishopMagicShift[i])) = moves;
-    }
+
+namespace {
+
+// Every occupancy of every mask, enumerated with the carry-rippler trick,
+// stored at its black magic index. Slices overlap, so an entry may only be
+// written twice with the same attacks.
+constexpr std::array<U64, SLIDER_TABLE_SIZE> withMagics(
+    std::array<U64, SLIDER_TABLE_SIZE> table, const U64 (&masks)[64],
+    const U64 (&nums)[64], const int (&shifts)[64], const int (&offsets)[64],
+    U64 (*slide)(int, U64), int first, int last) {
+  for (int i = first; i <= last; i++) {
+    U64 occupied = 0;
+    do {
+      U64 attacks = slide(i, occupied);
+      U64& entry = table[offsets[i] +
+                         ((occupied | ~masks[i]) * nums[i] >> shifts[i])];
+      if (entry && entry != attacks) throw "magicnums.hpp has colliding magics";
+      entry = attacks;
+      occupied = (occupied - masks[i]) & masks[i];
+    } while (occupied);
   }
+  return table;
+}
 
-  // Pre-calculate rook attacks with magic bitboards
+// Filled in steps, each a separate evaluation within the compiler's
+// constexpr operation limit
+constexpr auto rookAttacksLow =
+    withMagics({}, rookMagicMask, rookMagicNum, rookMagicShift,
+               rookOffset, initMagicRook, A1, H4);
+constexpr auto rookAttacks =
+    withMagics(rookAttacksLow, rookMagicMask, rookMagicNum, rookMagicShift,
+               rookOffset, initMagicRook, A5, H8);
+
+#ifdef USE_PEXT
+// Carry-rippler order is pext index order, so the slices fill sequentially
+template <size_t N>
+constexpr std::array<U64, N> pextTable(const U64 (&masks)[64],
+                                       U64 (*slide)(int, U64)) {
+  std::array<U64, N> table{};
+  size_t next = 0;
   for (int i = 0; i < 64; i++) {
-    int squares[64];
-    int numsquares = 0;
-    U64 temp = rookMagicMask[i];
-
-    while (temp) {
-      U64 bitboard = temp & -temp;
-      squares[numsquares++] = BB::lsb(bitboard);
-      temp ^= bitboard;
-    }
-    for (temp = 0; temp < (U64)1 << numsquares; temp++) {
-      U64 tempoccupied = initOccupied(squares, numsquares, temp);
-      U64 moves = initMagicRook(i, tempoccupied);
-      *(rookAttacksInit[i] +
-        (tempoccupied * rookMagicNum[i] >> rookMagicShift[i])) = moves;
-    }
+    U64 occupied = 0;
+    do {
+      table[next++] = slide(i, occupied);
+      occupied = (occupied - masks[i]) & masks[i];
+    } while (occupied);
   }
+  return table;
 }
-
-// Translates line occupancy into an occupied-square bitboard
-U64 initOccupied(int* squares, int numSquares, U64 line_occupied) {
-  int i;
-  U64 ret = 0;
-
-  for (i = 0; i < numSquares; i++)
-    if (line_occupied & (U64)1 << i) ret |= (U64)1 << squares[i];
-  return ret;
+#endif
+
+}  // namespace
+
+constexpr std::array<U64, SLIDER_TABLE_SIZE> sliderAttacksDB =
+    withMagics(rookAttacks, bishopMagicMask, bishopMagicNum, bishopMagicShift,
+               bishopOffset, initMagicBishop, A1, H8);
+
+static_assert(getRookAttacksMagic(A1, 0) == 0x01010101010101FEull);
+static_assert(getBishopAttacksMagic(A1, 0) == 0x8040201008040200ull);
+
+#ifdef USE_PEXT
+constexpr std::array<U64, 102400> rookPextDB =
+    pextTable<102400>(rookMagicMask, initMagicRook);
+constexpr std::array<U64, 5248> bishopPextDB =
+    pextTable<5248>(bishopMagicMask, initMagicBishop);
+#endif
+
+// Whether the CPU can run the build's backend
+bool supported() {
+#ifdef USE_PEXT
+  return __builtin_cpu_supports("bmi2");
+#else
+  return true;
+#endif
 }
 
-U64 initMagicBishop(int square, U64 occupied) {
-  U64 ret = 0;
-  U64 bit;
-  U64 bit2;
-  U64 rowbits = (U64)0xFF << (8 * (square / 8));
-
-  bit = (U64)1 << square;
-  bit2 = bit;
-  do {
-    bit <<= 8 - 1;
-    bit2 >>= 1;
-    if (bit2 & rowbits)
-      ret |= bit;
-    else
-      break;
-  } while (bit && !(bit & occupied));
-
-  bit = (U64)1 << square;
-  bit2 = bit;
-  do {
-    bit <<= 8 + 1;
-    bit2 <<= 1;
-    if (bit2 & rowbits)
-      ret |= bit;
-    else
-      break;
-  } while (bit && !(bit & occupied));
-
-  bit = (U64)1 << square;
-  bit2 = bit;
-  do {
-    bit >>= 8 - 1;
-    bit2 <<= 1;
-    if (bit2 & rowbits)
-      ret |= bit;
-    else
-      break;
-  } while (bit && !(bit & occupied));
-
-  bit = (U64)1 << square;
-  bit2 = bit;
-  do {
-    bit >>= 8 + 1;
-    bit2 >>= 1;
-    if (bit2 & rowbits)
-      ret |= bit;
-    else
-      break;
-  } while (bit && !(bit & occupied));
-
-  return ret;
-}
+// Check the build's backend runs here and agrees with the reference
+// attacks for every occupancy of every mask
+bool verify() {
+  if (!supported()) return false;
 
-U64 initMagicRook(int square, U64 occupied) {
-  U64 ret = 0;
-  U64 bit;
-  U64 rowbits = (U64)0xFF << 8 * (square / 8);
-
-  bit = (U64)1 << square;
-  do {
-    bit <<= 8;
-    ret |= bit;
-  } while (bit && !(bit & occupied));
-
-  bit = (U64)1 << square;
-  do {
-    bit >>= 8;
-    ret |= bit;
-  } while (bit && !(bit & occupied));
-
-  bit = (U64)1 << square;
-  do {
-    bit <<= 1;
-    if (bit & rowbits)
-      ret |= bit;
-    else
-      break;
-  } while (!(bit & occupied));
-
-  bit = (U64)1 << square;
-  do {
-    bit >>= 1;
-    if (bit & rowbits)
-      ret |= bit;
-    else
-      break;
-  } while (!(bit & occupied));
-
-  return ret;
+  for (int i = 0; i < 64; i++) {
+    U64 subset = 0;
+    do {
+      if (getRookAttacks(Square(i), subset) != initMagicRook(i, subset))
+        return false;
+      subset = (subset - rookMagicMask[i]) & rookMagicMask[i];
+    } while (subset);
+
+    do {
+      if (getBishopAttacks(Square(i), subset) != initMagicBishop(i, subset))
+        return false;
+      subset = (subset - bishopMagicMask[i]) & bishopMagicMask[i];
+    } while (subset);
+  }
+  return true;
 }
 
-}  // namespace Magic
\ No newline at end of file
+}  // namespace Magics
@@ -1,12 +1,95 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <thread>
 #include "uci.hpp"
-#include "magics.hpp"
-#include "zobrist.hpp"
+#include "bench.hpp"
+#include "bitbase.hpp"
+#include "epd.hpp"
 
-int main()
+// latrunculi epd <file.epd> [depth N] [nodes N] [movetime MS] [threads N]
+int runEPD(int argc, char* argv[])
 {
-    Magics::init();
-    Zobrist::init();
+	std::ifstream is(argv[2]);
+	if (!is) {
+		std::cerr << "cannot open " << argv[2] << std::endl;
+		return 1;
+	}
+
+	SearchLimits limits;
+	size_t threads = std::thread::hardware_concurrency();
+	for (int i = 3; i + 1 < argc; i += 2) {
+		std::string name = argv[i];
+		if (name == "depth") limits.depth = std::stoi(argv[i + 1]);
+		else if (name == "nodes") limits.nodes = std::stoull(argv[i + 1]);
+		else if (name == "movetime") limits.movetime = std::stoi(argv[i + 1]);
+		else if (name == "threads") threads = std::stoul(argv[i + 1]);
+	}
+	if (!limits.depth && !limits.nodes && !limits.movetime) limits.depth = 6;
+
+	auto positions = EPD::load(is);
+	auto report = EPD::run(positions, limits, threads);
+
+	for (size_t i = 0; i < positions.size(); i++) {
+		auto& pos = positions[i];
+		auto& result = report.results[i];
+		if (result.skipped) {
+			std::cout << "! " << pos.id << " invalid fen " << pos.fen << std::endl;
+			continue;
+		}
+		std::cout << (result.solved ? "+ " : "- ") << pos.id << " " << result.move
+		          << " score " << result.score << " nodes " << result.nodes << std::endl;
+	}
+
+	std::cout << "solved " << report.solved << "/" << positions.size()
+	          << " skipped " << report.skipped
+	          << " nodes " << report.nodes
+	          << " time " << report.seconds
+	          << " nps " << (U64)(report.nodes / std::max(report.seconds, 1e-9)) << std::endl;
+	return 0;
+}
+
+// latrunculi bench [depth]
+// Exits non-zero when the default bench no longer matches the signature
+int runBench(int argc, char* argv[])
+{
+	int depth = argc > 2 ? std::stoi(argv[2]) : Bench::DEPTH;
+	auto report = Bench::run(depth, std::cout);
+
+	if (depth == Bench::DEPTH && report.nodes != Bench::SIGNATURE) {
+		std::cerr << "bench signature " << report.nodes << " does not match "
+		          << Bench::SIGNATURE << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+#ifdef USE_PEXT
+// The engine code of a PEXT build may use BMI2 anywhere, its static
+// initialisation included, so the CPU is checked before that runs. This
+// file isn't built for BMI2, and iostreams may not be set up yet.
+__attribute__((constructor(101))) static void checkBMI2()
+{
+	__builtin_cpu_init();
+	if (!__builtin_cpu_supports("bmi2")) {
+		std::fputs("this build uses PEXT and needs a CPU with BMI2\n", stderr);
+		std::_Exit(1);
+	}
+}
+#endif
+
+int main(int argc, char* argv[])
+{
+    Bitbases::init();
+
+	if (argc > 2 && std::string(argv[1]) == "epd")
+		return runEPD(argc, argv);
+
+	if (argc > 1 && std::string(argv[1]) == "bench")
+		return runBench(argc, argv);
 
 	UCI::Controller controller(std::cin, std::cout);
 	controller.loop();
@@ -0,0 +1,92 @@
+#include "material.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "eval.hpp"
+
+namespace Material {
+
+thread_local Table table;
+
+namespace {
+
+bool isBare(const Board& board, Color c) {
+    return board.count<PAWN>(c) == 0 && board.nonPawnMaterial(c) == 0;
+}
+
+int scaleFactor(const Board& board, Color c) {
+    // Endgame scale for side to move c, excluding the opposite colored
+    // bishops case which depends on where the bishops and pawns are
+    Color enemy = ~c;
+    int pawnCount = board.count<PAWN>(c);
+    int pawnCountEnemy = board.count<PAWN>(enemy);
+    int nonPawnMat = board.nonPawnMaterial(c);
+    int nonPawnMatEnemy = board.nonPawnMaterial(enemy);
+    int nonPawnMatDiff = std::abs(nonPawnMat - nonPawnMatEnemy);
+
+    // Check for drawish scenarios with no pawns and equal material
+    if (pawnCount == 0 && pawnCountEnemy == 0 && nonPawnMatDiff <= Eval::mgPieceValue(BISHOP)) {
+        return nonPawnMat < Eval::mgPieceValue(ROOK) ? 0 : 16;
+    }
+
+    // Single queen scenarios with minor pieces
+    int queenCount = board.count<QUEEN>(c);
+    if (queenCount + board.count<QUEEN>(enemy) == 1) {
+        int minorPieceCount = queenCount == 1
+                                  ? board.count<BISHOP>(enemy) + board.count<KNIGHT>(enemy)
+                                  : board.count<BISHOP>(c) + board.count<KNIGHT>(c);
+        return std::min(64, 36 + 4 * minorPieceCount);
+    }
+
+    // Default: scale proportionally with pawns
+    return std::min(64, 36 + 5 * pawnCount);
+}
+
+Endgame::EvalFn endgameEvaluator(const Board& board, Color strong) {
+    // Known endgames against a lone king
+    if (!isBare(board, ~strong)) return nullptr;
+
+    int pawns = board.count<PAWN>(strong);
+    int knights = board.count<KNIGHT>(strong);
+    int bishops = board.count<BISHOP>(strong);
+    int npm = board.nonPawnMaterial(strong);
+
+    if (pawns == 0 && knights == 1 && bishops == 1 &&
+        npm == Eval::mgPieceValue(KNIGHT) + Eval::mgPieceValue(BISHOP)) {
+        return Endgame::KBNK;
+    }
+    if (pawns == 1 && npm == 0) return Endgame::KPK;
+    if (npm >= Eval::mgPieceValue(ROOK)) return Endgame::KXK;
+    return nullptr;
+}
+
+}  // namespace
+
+void init(Entry& entry, const Board& board) {
+    int npm = board.nonPawnMaterial(WHITE) + board.nonPawnMaterial(BLACK);
+
+    entry.key = board.materialKey;
+    entry.phase = Eval::calculatePhase(npm);
+    entry.evaluator = nullptr;
+    entry.strongSide = WHITE;
+
+    for (Color c : {WHITE, BLACK}) {
+        entry.scale[c] = scaleFactor(board, c);
+
+        if (Endgame::EvalFn evaluator = endgameEvaluator(board, c)) {
+            entry.evaluator = evaluator;
+            entry.strongSide = c;
+        }
+    }
+
+    // Same test as Board::oppositeBishopsEndGame, minus the square colors,
+    // and only where the no pawns rule above didn't already decide
+    bool noPawnsDraw = board.count<PAWN>(WHITE) + board.count<PAWN>(BLACK) == 0 &&
+                       std::abs(board.nonPawnMaterial(WHITE) - board.nonPawnMaterial(BLACK)) <=
+                           Eval::mgPieceValue(BISHOP);
+    entry.oppositeBishops =
+        board.count<BISHOP>(WHITE) == 1 && board.count<BISHOP>(BLACK) == 1 && !noPawnsDraw;
+}
+
+}  // namespace Material
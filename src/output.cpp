@@ -0,0 +1,64 @@
+#include "output.hpp"
+
+#include <iostream>
+
+Output::Output(std::ostream& os) : os(os) { writer = std::thread([this] { writerLoop(); }); }
+
+Output::~Output() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    hasText.notify_one();
+    writer.join();
+}
+
+void Output::write(std::string_view text) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffer.append(text);
+    }
+    hasText.notify_one();
+}
+
+bool Output::post(std::string_view text) {
+    // Progress reports are superseded by the next one, so rather than
+    // letting them pile up behind a stalled reader they are dropped
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (buffer.size() + text.size() > MAX_BACKLOG) return false;
+        buffer.append(text);
+    }
+    hasText.notify_one();
+    return true;
+}
+
+void Output::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    drained.wait(lock, [this] { return buffer.empty() && !writing; });
+}
+
+void Output::writerLoop() {
+    std::string text;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            writing = false;
+            if (buffer.empty()) drained.notify_all();
+
+            hasText.wait(lock, [this] { return stopping || !buffer.empty(); });
+            if (buffer.empty()) return;
+            text.swap(buffer);
+            writing = true;
+        }
+
+        os.write(text.data(), text.size());
+        os.flush();
+        text.clear();
+    }
+}
+
+Output& Output::console() {
+    static Output output(std::cout);
+    return output;
+}
@@ -0,0 +1,122 @@
+#include "perf.hpp"
+
+#include <iomanip>
+
+#ifdef PERF_COUNTERS
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+namespace Perf {
+
+namespace {
+
+const char* NAMES[N_EVENTS] = {"cycles", "instructions", "l1d-misses", "llc-misses",
+                               "branch-misses"};
+
+#ifdef PERF_COUNTERS
+int openEvent(Event event) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    switch (event) {
+        case CYCLES: attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+        case INSTRUCTIONS: attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+        case LLC_MISSES: attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+        case BRANCH_MISSES: attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+        case L1D_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 |
+                          PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+            break;
+        default: return -1;
+    }
+
+    // This thread on any cpu, each event on its own so one the CPU lacks
+    // doesn't take the others down with it
+    return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+}  // namespace
+
+bool Sample::any() const {
+    for (bool c : counted) {
+        if (c) return true;
+    }
+    return false;
+}
+
+std::ostream& print(std::ostream& os, const Sample& sample, U64 nodes) {
+    auto flags = os.flags();
+    auto precision = os.precision();
+    os << std::fixed << std::setprecision(2);
+
+    os << " time " << int(sample.seconds * 1000);
+    if (sample.counted[CYCLES] && sample.counted[INSTRUCTIONS] && sample.counts[CYCLES])
+        os << " ipc " << double(sample.counts[INSTRUCTIONS]) / sample.counts[CYCLES];
+
+    for (int e = CYCLES; e < N_EVENTS; ++e) {
+        if (e != INSTRUCTIONS && sample.counted[e] && nodes)
+            os << " " << NAMES[e] << "/node " << double(sample.counts[e]) / nodes;
+    }
+
+    os.flags(flags);
+    os.precision(precision);
+    return os;
+}
+
+Counters::Counters() {
+    for (int e = CYCLES; e < N_EVENTS; ++e) {
+#ifdef PERF_COUNTERS
+        fds[e] = openEvent(Event(e));
+#else
+        fds[e] = -1;
+#endif
+    }
+}
+
+Counters::~Counters() {
+#ifdef PERF_COUNTERS
+    for (int fd : fds) {
+        if (fd != -1) close(fd);
+    }
+#endif
+}
+
+void Counters::start() {
+#ifdef PERF_COUNTERS
+    for (int fd : fds) {
+        if (fd == -1) continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+    begin = std::chrono::steady_clock::now();
+}
+
+Sample Counters::stop() {
+    Sample sample;
+    sample.seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+#ifdef PERF_COUNTERS
+    for (int e = CYCLES; e < N_EVENTS; ++e) {
+        if (fds[e] == -1) continue;
+        ioctl(fds[e], PERF_EVENT_IOC_DISABLE, 0);
+        sample.counted[e] = read(fds[e], &sample.counts[e], sizeof(U64)) == sizeof(U64);
+    }
+#endif
+    return sample;
+}
+
+}  // namespace Perf
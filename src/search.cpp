@@ -1,21 +1,46 @@
 #include <algorithm>
 #include <cstdlib>
+#include <optional>
+#include <sstream>
+#include <thread>
 #include "search.hpp"
 #include "movegen.hpp"
+#include "perf.hpp"
 #include "chess.hpp"
 #include "tt.hpp"
 
 using namespace std::chrono;
 
 int MATESCORE = 32000;
+int DRAWSCORE = 0;
 
 void Search::think(int depth)
+{
+    SearchLimits depthLimit;
+    depthLimit.depth = depth;
+    think(depthLimit);
+}
+
+void Search::think(const SearchLimits& _limits)
 {
     reset();
+    limits = _limits;
+
+    Perf::Counters counters;
+    counters.start();
+
+    int depth = MAX_DEPTH - 1;
+    if (limits.depth > 0)
+        depth = std::min(limits.depth, depth);
 
     for (int i = 1; i < depth + 1; i++)
     {
-        bestScore = negamax<true>(i, -MATESCORE, MATESCORE);
+        // An interrupted iteration is thrown away, except for a best move
+        // that was fully searched before the limit hit
+        int score = negamax<true>(i, -MATESCORE, MATESCORE);
+        if (stopped)
+            break;
+        bestScore = score;
 
         if (abs(bestScore) > MATESCORE - 1000)
             break;
@@ -23,267 +48,354 @@ void Search::think(int depth)
             break;
     }
 
-    std::cout << "bestmove " << bestMove << std::endl;
+    // Until told otherwise, so the GUI gets its move once it asks for it
+    while ((limits.infinite || pondering) && !stopRequest)
+        std::this_thread::sleep_for(milliseconds(1));
+
+    if (silent)
+        return;
+
+    // The final info is never held back or dropped
+    showInfo(true);
+
+    std::ostringstream text;
+    if (Perf::ENABLED)
+    {
+        text << "info string nodes " << nSearched;
+        Perf::print(text, counters.stop(), nSearched) << "\n";
+    }
+    text << "bestmove " << bestMove << "\n";
+    output->write(text.str());
+}
+
+void Search::startThinking(const SearchLimits& _limits)
+{
+    // Signals are reset before the thread exists, so none sent once this
+    // returns can be lost
+    wait();
+    stopRequest = false;
+    pondering = _limits.ponder;
+    thread = std::thread([this, _limits] { think(_limits); });
+}
+
+void Search::wait()
+{
+    if (thread.joinable())
+        thread.join();
 }
 
 template<bool Root>
 int Search::negamax(int depth, int alpha, int beta, bool isPV, bool isNullAllowed)
 {
-    // int score = 0;
-    // int bestScoreSoFar = -MATESCORE;
-    // Move bestMoveSoFar = Move();
-    // NodeType ttType = TT_ALPHA;
-
-    // if (Root) {
-    //     nSearched = 0;
-    //     searchPly = 0;
-    // }
-
-    // // Clear the line
-    // pv[searchPly].clear();
-
-    // // If in check, search deeper
-    // bool wasInCheck = _board->isCheck();
-    // if (wasInCheck)
-    //     depth += 1;
-
-    // // If we've reach max depth, begin static evaluation of the board
-    // if (depth == 0)
-    //     return quiesce(alpha, beta);
-    
-    // // First check the transposition table
-    // Move hashMove = Move();
-    // TT::Entry* entry = nullptr;
-    // if (!Root) {
-    //     entry = TT::table.probe(_board->getKey());
-
-    //     if (entry) {
-    //         // If we have a table hit, use hash move for move ordering
-    //         hashMove = entry->best;
-    //         int hashScore = 0;
-
-    //         // If an exact hit with sufficient depth,
-    //         // we aren't in a PV node and score is inside the search window:
-    //         // Then return the previous score
-    //         if (entry->flag == TT_EXACT
-    //             && entry->depth >= depth)
-    //         {
-    //             hashScore = entry->score;
-    //             if (!isPV || (alpha < hashScore && hashScore < beta))
-    //                 return hashScore;
-    //         }
-
-    //         // Otherwise return if upper or lower bound in the TT
-    //         // is able to produce a cutoff
-    //         else if (entry->flag == TT_ALPHA
-    //                  && entry->score <= alpha
-    //                  && entry->depth >= depth)
-    //         {
-    //             hashScore = alpha;
-    //             if (!isPV)
-    //                 return hashScore;
-    //         }
-    //         else if (entry->flag == TT_BETA
-    //                  && entry->score >= beta
-    //                  && entry->depth >= depth)
-    //         {
-    //             hashScore = beta;
-    //             if (!isPV)
-    //                 return hashScore;
-    //         }
-
-    //     }
-
-    //     // Null move pruning
-    //     // Allow opponent to make two moves in a row, and
-    //     // search for a beta cutoff at a reduced depth, R
-    //     // Avoid if in zugzwang
-    //     int R = 3;
-    //     if (depth > 7)
-    //         R = 4;
-    //     if (isNullAllowed
-    //         && depth > R
-    //         && !isPV
-    //         && !wasInCheck
-    //         && _board->getPieceCount(_board->turn) > 0)
-    //     {
-    //         _board->makeNull();
-    //         ++searchPly;
-    //         score = -negamax<false>(depth-R-1, -beta, -beta+1, false, false);
-    //         --searchPly;
-    //         _board->unmmakeNull();
-
-    //         if (score >= beta)
-    //             return beta;
-    //     }
-    // }
-
-    // // Generate and sort moves
-    // int nLegalMoves = 0;
-    // auto movegen = MoveGenerator(_board);
-    // movegen.generatePseudoLegalMoves();
-    // sortMoves(movegen.moves, hashMove);
-
-    // // For each move
-    // for (auto& move : movegen.moves)
-    // {
-    //     // First check if move is legal
-    //     if (!_board->isPseudoLegalMoveLegal(move))
-    //         continue;
-    //     else {
-    //         nSearched++;
-    //         nLegalMoves++;
-    //     }
-
-    //     // Make the move
-    //     _board->make(move);
-    //     searchPly++;
-
-    //     // Late move reductions
-    //     // Search likely fail low nodes at a reduced depth
-    //     int lmrReduction = 0;
-    //     if (!Root) {
-    //         if (!isPV
-    //             && depth > 3
-    //             && nLegalMoves > 3
-    //             && !wasInCheck
-    //             && !_board->isCheck()
-    //             && _board->state[_board->ply].captured == NO_PIECE_TYPE
-    //             && move.type() != PROMOTION)
-    //         {
-    //             if (nLegalMoves > 8)
-    //                 lmrReduction += 2;
-    //             else
-    //                 lmrReduction += 1;
-    //         }
-    //     }
-
-    //     // PVS search
-    //     // Search first move, or PV move, with full window
-    //     int nextDepth = depth - lmrReduction - 1;
-    //     if (bestScoreSoFar == -MATESCORE)
-    //         score = -negamax<false>(nextDepth, -beta, -alpha);
-    //     // For remaining moves, search with null window centered around alpha
-    //     // in order to quickly check if it is an improvement, re-searching if so
-    //     else
-    //     {
-    //         score = -negamax<false>(nextDepth, -alpha-1, -alpha, isPV=false);
-    //         if ((score > alpha) && (score < beta))
-    //             score = -negamax<false>(nextDepth, -beta, -alpha);
-    //     }
-    //     // If a search with LMR raises alpha, re-search to full depth
-    //     // since we expected a bad move
-    //     if (score > alpha && lmrReduction > 0)
-    //         score = -negamax<false>(depth-1, -beta, -alpha);
-    //     bestScoreSoFar = std::max(bestScoreSoFar, score);
-
-    //     // Undo the move on the board
-    //     searchPly--;
-    //     _board->unmake();
-
-    //     if (score > alpha)
-    //     {
-    //         // Update best move if score is above lower bound
-    //         bestMoveSoFar = move;
-
-    //         if (score >= beta)
-    //         {
-    //             // If we have a beta cutoff, stop search since our opponent
-    //             // has better available moves one ply up
-    //             addToHistory(move, searchPly);
-    //             ttType = TT_BETA;
-    //             alpha = beta;
-    //             if (Root)
-    //                 printPV(depth, beta, nSearched);
-    //             break;
-    //         }
-
-    //         ttType = TT_EXACT;
-    //         alpha = score;
-    //         savePV(move);
-
-    //         if (Root)
-    //         {
-    //             bestMove = move;
-    //             printPV(depth, alpha, nSearched);
-    //         }
-    //     }
-    // }
-
-    // // Mate and draw detection
-    // if (nLegalMoves == 0)
-    // {
-    //     bestMoveSoFar = Move();
-    //     if (wasInCheck)
-    //         alpha = -MATESCORE + searchPly;
-    //     else
-    //         alpha = DRAWSCORE;
-    // }
-    // else if (_board->getHmClock() >= 100)
-    //     alpha = DRAWSCORE;
-
-    // // Save search results in the transposition table
-    // TT::table.save(_board->getKey(), depth, alpha, ttType, bestMoveSoFar);
+    int score = 0;
+    int bestScoreSoFar = -MATESCORE;
+    Move bestMoveSoFar = Move();
+    NodeType ttType = TT_ALPHA;
+
+    if (Root)
+        searchPly = 0;
+
+    if (stopped)
+        return 0;
+
+    // Clear the line
+    pv[searchPly].clear();
+
+    if (!Root) {
+        // Repetitions and the fifty move rule end the line in a draw
+        if (chess->isDraw(searchPly))
+            return DRAWSCORE;
+
+        // A move back into a position of the tree is available, so the
+        // side to move can always get at least a draw
+        if (alpha < DRAWSCORE && chess->hasUpcomingRepetition(searchPly)) {
+            alpha = DRAWSCORE;
+            if (alpha >= beta)
+                return alpha;
+        }
+    }
+
+    // If in check, search deeper
+    bool wasInCheck = chess->isCheck();
+    if (wasInCheck)
+        depth += 1;
+
+    // If we've reach max depth, begin static evaluation of the board
+    if (depth <= 0 || searchPly >= MAX_DEPTH - 1)
+        return quiesce(alpha, beta);
+
+    stats.add(isPV ? PV_NODES : NON_PV_NODES);
+
+    // First check the transposition table
+    Move hashMove = Move();
+    TT::Entry* entry = nullptr;
+    if (!Root) {
+        entry = tt.probe(chess->getKey());
+        stats.add(TT_PROBES);
+
+        if (entry) {
+            stats.add(TT_HITS);
+
+            // If we have a table hit, use hash move for move ordering
+            hashMove = entry->best;
+            int hashScore = 0;
+
+            // If an exact hit with sufficient depth,
+            // we aren't in a PV node and score is inside the search window:
+            // Then return the previous score
+            if (entry->flag == TT_EXACT
+                && entry->depth >= depth)
+            {
+                hashScore = entry->score;
+                if (!isPV || (alpha < hashScore && hashScore < beta)) {
+                    stats.add(TT_CUTOFFS);
+                    return hashScore;
+                }
+            }
+
+            // Otherwise return if upper or lower bound in the TT
+            // is able to produce a cutoff
+            else if (entry->flag == TT_ALPHA
+                     && entry->score <= alpha
+                     && entry->depth >= depth)
+            {
+                hashScore = alpha;
+                if (!isPV) {
+                    stats.add(TT_CUTOFFS);
+                    return hashScore;
+                }
+            }
+            else if (entry->flag == TT_BETA
+                     && entry->score >= beta
+                     && entry->depth >= depth)
+            {
+                hashScore = beta;
+                if (!isPV) {
+                    stats.add(TT_CUTOFFS);
+                    return hashScore;
+                }
+            }
+
+        }
+
+        // Null move pruning
+        // Allow opponent to make two moves in a row, and
+        // search for a beta cutoff at a reduced depth, R
+        // Avoid if in zugzwang
+        int R = 3;
+        if (depth > 7)
+            R = 4;
+        if (isNullAllowed
+            && depth > R
+            && !isPV
+            && !wasInCheck
+            && chess->nonPawnMaterial(chess->getTurn()) > 0)
+        {
+            stats.add(NULL_MOVE_TRIES);
+            chess->makeNull();
+            ++searchPly;
+            score = -negamax<false>(depth-R-1, -beta, -beta+1, false, false);
+            --searchPly;
+            chess->unmmakeNull();
+
+            if (score >= beta) {
+                stats.add(NULL_MOVE_CUTOFFS);
+                return beta;
+            }
+        }
+    }
+
+    // Generate and sort moves
+    int nLegalMoves = 0;
+    auto movegen = MoveGenerator(chess);
+    movegen.generatePseudoLegalMoves();
+    sortMoves(movegen.moves, hashMove);
+
+    // For each move
+    for (auto& move : movegen.moves)
+    {
+        // First check if move is legal
+        if (!chess->isPseudoLegalMoveLegal(move))
+            continue;
+        else {
+            nSearched++;
+            nLegalMoves++;
+            checkLimits();
+        }
+
+        // Make the move
+        chess->make(move);
+        searchPly++;
+
+        // Late move reductions
+        // Search likely fail low nodes at a reduced depth
+        int lmrReduction = 0;
+        if (!Root) {
+            if (!isPV
+                && depth > 3
+                && nLegalMoves > 3
+                && !wasInCheck
+                && !chess->isCheck()
+                && chess->getCaptured() == NO_PIECE_TYPE
+                && move.type() != PROMOTION)
+            {
+                if (nLegalMoves > 8)
+                    lmrReduction += 2;
+                else
+                    lmrReduction += 1;
+                stats.add(LMR_REDUCTIONS);
+            }
+        }
+
+        // PVS search
+        // Search first move, or PV move, with full window
+        int nextDepth = depth - lmrReduction - 1;
+        if (bestScoreSoFar == -MATESCORE)
+            score = -negamax<false>(nextDepth, -beta, -alpha, isPV);
+        // For remaining moves, search with null window centered around alpha
+        // in order to quickly check if it is an improvement, re-searching if so
+        else
+        {
+            score = -negamax<false>(nextDepth, -alpha-1, -alpha, false);
+            if ((score > alpha) && (score < beta))
+                score = -negamax<false>(nextDepth, -beta, -alpha, isPV);
+        }
+        // If a search with LMR raises alpha, re-search to full depth
+        // since we expected a bad move
+        if (score > alpha && lmrReduction > 0)
+        {
+            stats.add(LMR_RESEARCHES);
+            score = -negamax<false>(depth-1, -beta, -alpha, isPV);
+        }
+        bestScoreSoFar = std::max(bestScoreSoFar, score);
+
+        // Undo the move on the board
+        searchPly--;
+        chess->unmake();
+
+        if (stopped)
+            return 0;
+
+        if (score > alpha)
+        {
+            // Update best move if score is above lower bound
+            bestMoveSoFar = move;
+
+            if (score >= beta)
+            {
+                // If we have a beta cutoff, stop search since our opponent
+                // has better available moves one ply up
+                addToHistory(move, depth);
+                stats.add(CUT_NODES);
+                if (nLegalMoves == 1)
+                    stats.add(FIRST_MOVE_CUTOFFS);
+                ttType = TT_BETA;
+                alpha = beta;
+                if (Root)
+                    printPV(depth, beta, nSearched);
+                break;
+            }
+
+            ttType = TT_EXACT;
+            alpha = score;
+            savePV(move);
+
+            if (Root)
+            {
+                bestMove = move;
+                printPV(depth, alpha, nSearched);
+            }
+        }
+    }
+
+    // Mate and draw detection
+    if (nLegalMoves == 0)
+    {
+        bestMoveSoFar = Move();
+        if (wasInCheck)
+            alpha = -MATESCORE + searchPly;
+        else
+            alpha = DRAWSCORE;
+    }
+    else if (chess->getHmClock() >= 100)
+        alpha = DRAWSCORE;
+
+    if (ttType != TT_BETA)
+        stats.add(ttType == TT_EXACT ? EXACT_NODES : ALL_NODES);
+
+    // Save search results in the transposition table
+    tt.save(chess->getKey(), depth, alpha, ttType, bestMoveSoFar);
 
     return alpha;
 }
 
-int Search::quiesce(int alpha, int beta)
+int Search::quiesce(int alpha, int beta, int qsDepth)
 {
-    // int score = _board->eval();
-    
-    // if (score >= beta)
-    //     return beta;
+    stats.add(QSEARCH_NODES);
+    stats.qsearchDepth(qsDepth);
+
+    // In check every evasion is searched and standing pat is not an option
+    bool inCheck = chess->isCheck();
+    int score = inCheck ? -MATESCORE + searchPly : chess->eval<false>();
+
+    if (score >= beta)
+        return beta;
 
-    // if (searchPly > MAX_DEPTH)
-    //     return score;
+    if (searchPly >= MAX_DEPTH - 1)
+        return score;
 
-    // if (score > alpha)
-    //     alpha = score;
+    if (score > alpha)
+        alpha = score;
 
-    // int nLegalMoves = 0;
-    // auto movegen = MoveGenerator(_board);
-    // movegen.generateCaptures();
-    // sortMoves(movegen.moves);
+    auto movegen = MoveGenerator(chess);
+    if (inCheck)
+        movegen.generatePseudoLegalMoves();
+    else
+        movegen.generateCaptures();
+    sortMoves(movegen.moves);
 
-    // for (auto& move : movegen.moves)
-    // {
-    //     if (!_board->isPseudoLegalMoveLegal(move))
-    //         continue;
-    //     else
-    //         nLegalMoves++;
+    for (auto& move : movegen.moves)
+    {
+        if (!chess->isPseudoLegalMoveLegal(move))
+            continue;
 
-    //     _board->make(move);
-    //     searchPly++;
+        nSearched++;
+        checkLimits();
+        chess->make(move);
+        searchPly++;
 
-    //     score = -quiesce(-beta, -alpha);
+        score = -quiesce(-beta, -alpha, qsDepth + 1);
 
-    //     searchPly--;
-    //     _board->unmake();
+        searchPly--;
+        chess->unmake();
 
-    //     if (score >= beta)
-    //         return beta;
-    //     if (score > alpha)
-    //         alpha = score;
-    // }
+        if (stopped)
+            return 0;
 
-    // if (nLegalMoves == 0 && _board->isCheck())
-    //     return -MATESCORE + searchPly;
-    // else if (_board->getHmClock() >= 100)
-    //     return DRAWSCORE;
+        if (score >= beta)
+            return beta;
+        if (score > alpha)
+            alpha = score;
+    }
 
     return alpha;
 }
 
-template<bool Root, bool ShowOutput = true>
+template<bool Root, bool ShowOutput>
 U64 Search::perft(int depth)
 {
     if (depth == 0)
         return 1;
 
+    // Counters are only read at the root, opening them at every node would
+    // cost more than the moves being counted
+    std::optional<Perf::Counters> counters;
     if (Root && ShowOutput)
+    {
         start = high_resolution_clock::now();
-
+        counters.emplace();
+        counters->start();
+    }
 
     auto movegen = MoveGenerator(chess);
     movegen.generatePseudoLegalMoves();
@@ -291,6 +403,11 @@ U64 Search::perft(int depth)
     U64 count = 0,
         nodes = 0;
 
+    // Likewise the text, which is only written at the root
+    std::optional<std::ostringstream> text;
+    if (Root && ShowOutput)
+        text.emplace();
+
     for (auto& move : movegen.moves)
     {
         if (!chess->isPseudoLegalMoveLegal(move))
@@ -302,7 +419,7 @@ U64 Search::perft(int depth)
         nodes += count;
 
         if (Root && ShowOutput)
-            std::cout << move << ": " << count << std::endl;
+            *text << move << ": " << count << "\n";
 
         chess->unmake();
     }
@@ -312,9 +429,16 @@ U64 Search::perft(int depth)
         stop = high_resolution_clock::now();
 
         duration<double> d = duration_cast<duration<double>>(stop - start);
-        std::cout << "TOTAL TIME OF SEARCH: " << d.count() << std::endl;
-        std::cout << "TOTAL NODES SEARCHED: " << nodes << std::endl;
-        std::cout << "NODES PER SECOND    : " << nodes / d.count() << std::endl;
+        *text << "TOTAL TIME OF SEARCH: " << d.count() << "\n";
+        *text << "TOTAL NODES SEARCHED: " << nodes << "\n";
+        *text << "NODES PER SECOND    : " << nodes / d.count() << "\n";
+
+        if (Perf::ENABLED)
+            Perf::print(*text << "PERF COUNTERS       :", counters->stop(), nodes) << "\n";
+
+        // Written in one piece once done, the root moves don't wait on the
+        // reader one by one
+        output->write(text->str());
     }
 
     return nodes;
@@ -322,50 +446,101 @@ U64 Search::perft(int depth)
 
 void Search::reset()
 {
+    bestMove = Move();
+    bestScore = 0;
+    nSearched = 0;
+    stopped = false;
+    stats.clear();
+
     // Reset the PV collector
     for (int i = 0; i < MAX_DEPTH; i++)
         pv[i].clear();
 
-    // Zero the history table
+    // Killers and history carry over from the last search, which was most
+    // likely of the position a move or two ago. History is halved so what
+    // this search finds soon outweighs it.
     for (int c = 0; c < 2; c++) {
         for (int p = 0; p < 6; p++) {
             for (int sq = 0; sq < 64; sq++) {
-                history[c][p][sq] = 0;
+                history[c][p][sq] >>= 1;
             }
         }
     }
 
-    // Start the clock
+    // Start the clock, the first info is shown straight away
     start = high_resolution_clock::now();
+    lastInfo = high_resolution_clock::time_point();
+    pendingInfo.clear();
 }
 
-void Search::addToHistory(Move move, int ply)
+void Search::newGame()
 {
-    // PieceRole captPiece = _board->getPieceType(move.to());
-    // if (captPiece == NO_PIECE_TYPE && move.type() != PROMOTION)
-    // {
-    //     // Add to killer moves
-    //     killers[ply].move2 = killers[ply].move1;
-    //     killers[ply].move1 = move;
-
-    //     // Add to history table
-    //     PieceRole movePiece = _board->getPieceType(move.from());
-    //     history[_board->turn][movePiece][move.to()] += (U32)1 << (U64)ply; // ply^2
-
-    //     if (history[_board->turn][movePiece][move.to()] > 10000)
-    //     {
-    //         for (int c = 0; c < 2; c++) {
-    //             for (int p = 0; p < 6; p++) {
-    //                 for (int sq = 0; sq < 64; sq++) {
-    //                     history[c][p][sq] >>= 2;
-    //                 }
-    //             }
-    //         }
-    //     }
-    // }
+    // Nothing learned in another game applies
+    bestMove = Move();
+    tt.clear();
+    std::fill(std::begin(killers), std::end(killers), Killer());
+    for (auto& side : history)
+        for (auto& piece : side)
+            std::fill(std::begin(piece), std::end(piece), 0);
+}
+
+void Search::addToHistory(Move move, int depth)
+{
+    PieceType captPiece = Defs::getPieceType(chess->getPiece(move.to()));
+    if (captPiece == NO_PIECE_TYPE && move.type() != PROMOTION)
+    {
+        // Add to killer moves
+        killers[searchPly].move2 = killers[searchPly].move1;
+        killers[searchPly].move1 = move;
+
+        // Add to history table
+        Color turn = chess->getTurn();
+        PieceType movePiece = Defs::getPieceType(chess->getPiece(move.from()));
+        history[turn][movePiece - PAWN][move.to()] += depth * depth;
+
+        if (history[turn][movePiece - PAWN][move.to()] > 10000)
+        {
+            for (int c = 0; c < 2; c++) {
+                for (int p = 0; p < 6; p++) {
+                    for (int sq = 0; sq < 64; sq++) {
+                        history[c][p][sq] >>= 2;
+                    }
+                }
+            }
+        }
+    }
 }
 
 
+void Search::checkLimits()
+{
+    if (stopRequest.load(std::memory_order_relaxed))
+    {
+        stopped = true;
+        return;
+    }
+
+    // Node counts are cheap to compare, the clock is only read every 1024 nodes
+    if (limits.nodes && nSearched >= limits.nodes)
+        stopped = true;
+    else if (limits.movetime && (nSearched & 1023) == 0)
+    {
+        auto now = high_resolution_clock::now();
+
+        // The clock stands still while pondering and starts on ponderhit
+        if (limits.ponder)
+        {
+            if (pondering)
+                return;
+            limits.ponder = false;
+            start = now;
+        }
+
+        if (duration_cast<milliseconds>(now - start).count() >= limits.movetime)
+            stopped = true;
+    }
+}
+
 void Search::savePV(Move move)
 {
     U32 ply = (U32) searchPly;
@@ -378,55 +553,81 @@ void Search::savePV(Move move)
               std::back_inserter(pv[ply]));
 }
 
-void Search::printPV(int depth, int score, unsigned int nSearched)
+void Search::printPV(int depth, int score, U64 nSearched)
 {
+    if (silent)
+        return;
+
     stop = high_resolution_clock::now();
     duration<double> d = duration_cast<duration<double>>(stop - start);
 
-    std::cout << "info depth " << depth;
-    std::cout << " score cp " << score;
-    std::cout << " nodes " << nSearched;
-    std::cout << " nps " << (U32)(nSearched / d.count());
-    std::cout << " time " << (int)(d.count() * 1000) << "\n";
+    std::ostringstream text;
+    text << "info depth " << depth;
+    text << " score cp " << score;
+    text << " nodes " << nSearched;
+    text << " nps " << (U64)(nSearched / d.count());
+    text << " time " << (int)(d.count() * 1000) << "\n";
     
-    std::cout << "pv ";
+    text << "pv ";
     for (auto& m : pv[0])
-        std::cout << m << " ";
-    std::cout << std::endl;
+        text << m << " ";
+    text << "\n";
+
+    pendingInfo = text.str();
+    showInfo(false);
+}
+
+void Search::showInfo(bool last)
+{
+    // Info closer together than INFO_INTERVAL is held back, only the latest
+    // of those is shown. Updates the reader can't keep up with are dropped,
+    // they are superseded by the next one anyway.
+    if (pendingInfo.empty())
+        return;
+
+    auto now = high_resolution_clock::now();
+    if (last)
+        output->write(pendingInfo);
+    else if (now - lastInfo < milliseconds(INFO_INTERVAL) || !output->post(pendingInfo))
+        return;
+
+    pendingInfo.clear();
+    lastInfo = now;
 }
 
 
 void Search::sortMoves(std::vector<Move>& moves, Move hashmove)
 {
-    // for (auto& move : moves)
-    // {
-    //     if (move == bestMove)
-    //         move.score += 10001;
-        
-    //     if (move == hashmove && !hashmove.isNullMove())
-    //         move.score += 10000;
-
-    //     if (move.type() == PROMOTION)
-    //         move.score += 1000 + move.promoPiece();
-
-    //     PieceRole captPiece = _board->getPieceType(move.to());
-    //     if (captPiece != NO_PIECE_TYPE) {
-    //         PieceRole movePiece = _board->getPieceType(move.from());
-    //         move.score += Eval::PieceValues[captPiece][WHITE] - movePiece;
-    //     }
-    //     else {
-    //         PieceRole movePiece = _board->getPieceType(move.from());
-    //         move.score += (I32)history[_board->turn][movePiece][move.to()];
-    //     }
-
-    //     if (move == killers[searchPly].move1)
-    //         move.score += 100;
-
-    //     if (move == killers[searchPly].move2)
-    //         move.score += 50;
-    // }
-
-    // std::stable_sort(moves.rbegin(), moves.rend());
+    Color turn = chess->getTurn();
+
+    for (auto& move : moves)
+    {
+        if (move == bestMove)
+            move.score += 10001;
+
+        if (move == hashmove && !hashmove.isNullMove())
+            move.score += 10000;
+
+        if (move.type() == PROMOTION)
+            move.score += 1000 + move.promoPiece();
+
+        PieceType captPiece = Defs::getPieceType(chess->getPiece(move.to()));
+        PieceType movePiece = Defs::getPieceType(chess->getPiece(move.from()));
+        if (captPiece != NO_PIECE_TYPE) {
+            move.score += Eval::mgPieceValue(captPiece) - movePiece;
+        }
+        else {
+            move.score += (I32)history[turn][movePiece - PAWN][move.to()];
+        }
+
+        if (move == killers[searchPly].move1)
+            move.score += 100;
+
+        if (move == killers[searchPly].move2)
+            move.score += 50;
+    }
+
+    std::stable_sort(moves.rbegin(), moves.rend());
 }
 
 template U64 Search::perft<true>(int);
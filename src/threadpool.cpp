@@ -0,0 +1,47 @@
+#include "threadpool.hpp"
+
+ThreadPool::ThreadPool(size_t nThreads) {
+    nThreads = std::max<size_t>(nThreads, 1);
+    for (size_t i = 0; i < nThreads; ++i) workers.emplace_back([this] { workerLoop(); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push(std::move(job));
+        ++pending;
+    }
+    jobAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    jobsDone.wait(lock, [this] { return pending == 0; });
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty()) return;
+            job = std::move(jobs.front());
+            jobs.pop();
+        }
+
+        job();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0) jobsDone.notify_all();
+    }
+}
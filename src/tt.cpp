@@ -1,20 +1,20 @@
+#include <algorithm>
 #include <iostream>
 #include "tt.hpp"
 #include "move.hpp"
 
 namespace TT {
 
-    void Table::init(U32 nbytes)
+    void Table::resize(size_t mb)
     {
-        // Clear existing table
-        delete [] _table;
-
         // Determine size of transposition table
-        _size = nbytes / sizeof(Entry) / 2;
+        _size = mb * 1024 * 1024 / sizeof(Entry) / 2;
 
         try
         {
-            _table = new Entry [_size * 2];
+            // Replaces the existing table
+            _table.reset();
+            _table = std::make_unique<Entry[]>(_size * 2);
         }
         catch(std::bad_alloc& e)
         {
@@ -23,10 +23,15 @@ namespace TT {
         }
     }
 
+    void Table::clear()
+    {
+        std::fill(_table.get(), _table.get() + _size * 2, Entry());
+    }
+
     void Table::save(U64 zkey, U8 depth, int score, NodeType flags, Move best)
     {
-        int alwaysReplaceIx = zkey % _size;
-        int depthPreferredIx = alwaysReplaceIx + 1;
+        size_t alwaysReplaceIx = zkey % _size;
+        size_t depthPreferredIx = alwaysReplaceIx + 1;
 
         Entry* entry = &_table[depthPreferredIx];
         if (depth >= entry->depth)
@@ -43,8 +48,8 @@ namespace TT {
 
     Entry * Table::probe(U64 zkey) const
     {
-        int alwaysReplaceIx = zkey % _size;
-        int depthPreferredIx = alwaysReplaceIx + 1;
+        size_t alwaysReplaceIx = zkey % _size;
+        size_t depthPreferredIx = alwaysReplaceIx + 1;
 
         // Check the always replace entry first
         Entry* entry = &_table[alwaysReplaceIx];
@@ -78,7 +83,5 @@ namespace TT {
         return os;
     }
 
-    Table table = Table();
-
 }
     
\ No newline at end of file
@@ -0,0 +1,419 @@
+#include "tune.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+#include "board.hpp"
+#include "chess.hpp"
+#include "defs.hpp"
+#include "eval.hpp"
+
+namespace Tune {
+
+const char MAGIC[8] = {'L', 'A', 'T', 'T', 'U', 'N', 'E', '2'};
+
+// On disk each position is a fixed 12 byte record, the result a full
+// float so fractional labels survive, followed by nFeatures 3 byte
+// (index, coeff) pairs, little endian, no padding
+const size_t RECORD_SIZE = 12;
+const size_t FEATURE_SIZE = 3;
+
+bool Dataset::add(const std::string& fen, float result) {
+    std::vector<std::string> tokens = Defs::split(fen, ' ');
+    if (tokens.size() < 4) return false;
+
+    // Labeled EPD positions usually omit the move counters
+    auto isNumber = [](const std::string& token) {
+        return !token.empty() && std::all_of(token.begin(), token.end(), ::isdigit);
+    };
+    std::string position = tokens[0] + " " + tokens[1] + " " + tokens[2] + " " + tokens[3];
+    bool counters = tokens.size() >= 6 && isNumber(tokens[4]) && isNumber(tokens[5]);
+    position += counters ? " " + tokens[4] + " " + tokens[5] : " 0 1";
+
+    // A malformed position is skipped like any other bad line
+    Chess chess(STARTFEN);
+    if (!chess.setFromFEN(position)) return false;
+    Board board(position);
+
+    std::array<int, N_PARAMS> counts{};
+    for (int sq = A1; sq < N_SQUARES; ++sq) {
+        Piece piece = board.squares[sq];
+        if (piece == NO_PIECE) continue;
+
+        Color c = Defs::getPieceColor(piece);
+        PieceType pt = Defs::getPieceType(piece);
+        int sign = c == WHITE ? 1 : -1;
+
+        if (pt != KING) counts[PIECE_VALUES + pt - PAWN] += sign;
+        counts[pieceSquareIndex(pt, Eval::squareMap[c][sq])] += sign;
+    }
+
+    // Same pawn structure terms as Chess::pawnsEval
+    U64 wPawns = board.getPieces<PAWN>(WHITE);
+    U64 bPawns = board.getPieces<PAWN>(BLACK);
+    counts[ISO_PAWN] = BB::bitCount(Eval::isolatedPawns(wPawns)) -
+                       BB::bitCount(Eval::isolatedPawns(bPawns));
+    counts[BACKWARD_PAWN] = BB::bitCount(Eval::backwardsPawns<WHITE, BLACK>(wPawns, bPawns)) -
+                            BB::bitCount(Eval::backwardsPawns<BLACK, WHITE>(bPawns, wPawns));
+    counts[DOUBLED_PAWN] = BB::bitCount(Eval::doubledPawns<WHITE>(wPawns)) -
+                           BB::bitCount(Eval::doubledPawns<BLACK>(bPawns));
+
+    // Everything else in Chess::eval is held constant while tuning
+    Eval::EvalInfo info;
+    chess.initEvalInfo(info);
+    Score fixed = chess.piecesEval(info);
+    fixed += chess.kingEval(info);
+
+    Entry entry;
+    entry.result = result;
+    entry.phase = Eval::calculatePhase(board.nonPawnMaterial(WHITE) + board.nonPawnMaterial(BLACK));
+    entry.scale = chess.scaleFactor();
+    entry.tempo = tokens[1] == "w" ? 1 : -1;
+    entry.fixedMg = std::clamp(mgValue(fixed), -32768, 32767);
+    entry.fixedEg = std::clamp(egValue(fixed), -32768, 32767);
+    entry.offset = features.size();
+    entry.nFeatures = 0;
+
+    for (int i = 0; i < N_PARAMS; ++i) {
+        if (counts[i] == 0) continue;
+        features.push_back({static_cast<U16>(i), static_cast<I8>(counts[i])});
+        ++entry.nFeatures;
+    }
+
+    entries.push_back(entry);
+    return true;
+}
+
+bool parseResult(const std::string& line, float& result) {
+    // Accepts the common labels: 1-0 / 0-1 / 1/2-1/2 anywhere on the line,
+    // or a bracketed score such as [0.5]
+    if (line.find("1/2-1/2") != std::string::npos) {
+        result = 0.5f;
+    } else if (line.find("1-0") != std::string::npos) {
+        result = 1.0f;
+    } else if (line.find("0-1") != std::string::npos) {
+        result = 0.0f;
+    } else {
+        size_t open = line.rfind('[');
+        if (open == std::string::npos) return false;
+        result = std::strtof(line.c_str() + open + 1, nullptr);
+    }
+    return true;
+}
+
+size_t Dataset::convert(std::istream& is) {
+    size_t skipped = 0;
+    std::string line;
+    while (std::getline(is, line)) {
+        float result;
+        if (line.empty() || !parseResult(line, result) || !add(line, result)) ++skipped;
+    }
+    return skipped;
+}
+
+bool Dataset::save(const std::string& path) const {
+    std::ofstream os(path, std::ios::binary);
+    if (!os) return false;
+
+    U64 count = entries.size();
+    os.write(MAGIC, sizeof(MAGIC));
+    os.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+    std::vector<char> buffer;
+    for (const Entry& entry : entries) {
+        char record[RECORD_SIZE];
+        std::memcpy(record, &entry.result, 4);
+        record[4] = entry.phase;
+        record[5] = entry.scale;
+        record[6] = entry.tempo;
+        std::memcpy(record + 7, &entry.fixedMg, 2);
+        std::memcpy(record + 9, &entry.fixedEg, 2);
+        record[11] = entry.nFeatures;
+        buffer.insert(buffer.end(), record, record + RECORD_SIZE);
+
+        for (U32 i = 0; i < entry.nFeatures; ++i) {
+            const Feature& f = features[entry.offset + i];
+            char packed[FEATURE_SIZE];
+            std::memcpy(packed, &f.index, 2);
+            packed[2] = f.coeff;
+            buffer.insert(buffer.end(), packed, packed + FEATURE_SIZE);
+        }
+    }
+
+    os.write(buffer.data(), buffer.size());
+    return static_cast<bool>(os);
+}
+
+bool Dataset::load(const std::string& path) {
+    std::ifstream is(path, std::ios::binary);
+    if (!is) return false;
+
+    char magic[sizeof(MAGIC)];
+    U64 count;
+    is.read(magic, sizeof(magic));
+    is.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!is || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+
+    // Slurp the rest of the file and unpack it in one pass
+    std::vector<char> buffer((std::istreambuf_iterator<char>(is)),
+                             std::istreambuf_iterator<char>());
+    entries.clear();
+    features.clear();
+    entries.reserve(count);
+    features.reserve(buffer.size() / FEATURE_SIZE);
+
+    size_t pos = 0;
+    for (U64 n = 0; n < count; ++n) {
+        if (pos + RECORD_SIZE > buffer.size()) return false;
+        const char* record = buffer.data() + pos;
+
+        Entry entry;
+        std::memcpy(&entry.result, record, 4);
+        entry.phase = record[4];
+        entry.scale = record[5];
+        entry.tempo = record[6];
+        std::memcpy(&entry.fixedMg, record + 7, 2);
+        std::memcpy(&entry.fixedEg, record + 9, 2);
+        entry.nFeatures = record[11];
+        entry.offset = features.size();
+        pos += RECORD_SIZE;
+
+        if (pos + entry.nFeatures * FEATURE_SIZE > buffer.size()) return false;
+        for (U32 i = 0; i < entry.nFeatures; ++i) {
+            Feature f;
+            std::memcpy(&f.index, buffer.data() + pos, 2);
+            f.coeff = buffer[pos + 2];
+            if (f.index >= N_PARAMS) return false;
+            features.push_back(f);
+            pos += FEATURE_SIZE;
+        }
+        entries.push_back(entry);
+    }
+    return true;
+}
+
+Params initialParams() {
+    Params params(N_PARAMS);
+    for (int pt = PAWN; pt < KING; ++pt) {
+        params[PIECE_VALUES + pt - PAWN] = {double(Eval::mgPieceValue(PieceType(pt))),
+                                            double(Eval::egPieceValue(PieceType(pt)))};
+    }
+    for (int pt = PAWN; pt < N_PIECES; ++pt) {
+        for (int sq = A1; sq < N_SQUARES; ++sq) {
+            params[pieceSquareIndex(PieceType(pt), sq)] = {
+                double(Eval::pieceBonus[pt - PAWN][MIDGAME][sq]),
+                double(Eval::pieceBonus[pt - PAWN][ENDGAME][sq])};
+        }
+    }
+    params[ISO_PAWN] = {double(mgValue(Eval::ISO_PAWN_PENALTY)),
+                        double(egValue(Eval::ISO_PAWN_PENALTY))};
+    params[BACKWARD_PAWN] = {double(mgValue(Eval::BACKWARD_PAWN_PENALTY)),
+                             double(egValue(Eval::BACKWARD_PAWN_PENALTY))};
+    params[DOUBLED_PAWN] = {double(mgValue(Eval::DOUBLED_PAWN_PENALTY)),
+                            double(egValue(Eval::DOUBLED_PAWN_PENALTY))};
+    return params;
+}
+
+double linearEval(const Dataset& data, const Entry& entry, const Params& params) {
+    // Chess::eval with the tuned terms expanded as a sum of weighted
+    // features, from white's point of view
+    double mg = entry.fixedMg;
+    double eg = entry.fixedEg;
+    for (U32 i = 0; i < entry.nFeatures; ++i) {
+        const Feature& f = data.features[entry.offset + i];
+        mg += f.coeff * params[f.index].mg;
+        eg += f.coeff * params[f.index].eg;
+    }
+
+    double egScaled = eg * entry.scale / 64;
+    double score = (mg * entry.phase + egScaled * (Eval::PHASE_LIMIT - entry.phase)) /
+                   Eval::PHASE_LIMIT;
+    return score + entry.tempo * Eval::TEMPO_BONUS;
+}
+
+double sigmoid(double score, double k) { return 1.0 / (1.0 + std::exp(-k * score)); }
+
+double loss(const Dataset& data, const Params& params, double k, ThreadPool& pool) {
+    std::vector<double> partial(pool.size());
+    pool.parallelFor(data.size(), [&](size_t worker, size_t begin, size_t end) {
+        double sum = 0;
+        for (size_t i = begin; i < end; ++i) {
+            const Entry& entry = data.entries[i];
+            double error = entry.result - sigmoid(linearEval(data, entry, params), k);
+            sum += error * error;
+        }
+        partial[worker] = sum;
+    });
+
+    double total = 0;
+    for (double sum : partial) total += sum;
+    return total / std::max<size_t>(data.size(), 1);
+}
+
+void gradient(const Dataset& data,
+              const Params& params,
+              double k,
+              ThreadPool& pool,
+              Params& grad) {
+    // Each worker accumulates into its own gradient, merged afterwards
+    std::vector<Params> partial(pool.size(), Params(N_PARAMS));
+    pool.parallelFor(data.size(), [&](size_t worker, size_t begin, size_t end) {
+        Params& local = partial[worker];
+        for (size_t i = begin; i < end; ++i) {
+            const Entry& entry = data.entries[i];
+            double s = sigmoid(linearEval(data, entry, params), k);
+            double d = (s - entry.result) * s * (1 - s) * k;
+            double mgWeight = d * entry.phase / Eval::PHASE_LIMIT;
+            double egWeight = d * (Eval::PHASE_LIMIT - entry.phase) / Eval::PHASE_LIMIT *
+                              entry.scale / 64;
+
+            for (U32 j = 0; j < entry.nFeatures; ++j) {
+                const Feature& f = data.features[entry.offset + j];
+                local[f.index].mg += f.coeff * mgWeight;
+                local[f.index].eg += f.coeff * egWeight;
+            }
+        }
+    });
+
+    double norm = 2.0 / std::max<size_t>(data.size(), 1);
+    grad.assign(N_PARAMS, Weight());
+    for (const Params& local : partial) {
+        for (int i = 0; i < N_PARAMS; ++i) {
+            grad[i].mg += local[i].mg * norm;
+            grad[i].eg += local[i].eg * norm;
+        }
+    }
+}
+
+double fitK(const Dataset& data, const Params& params, ThreadPool& pool) {
+    // Golden section search for the sigmoid scale that best fits the
+    // untuned eval, so the optimizer only moves the parameters
+    const double ratio = (std::sqrt(5.0) - 1) / 2;
+    double lo = 0.0001, hi = 0.05;
+    double a = hi - ratio * (hi - lo), b = lo + ratio * (hi - lo);
+    double la = loss(data, params, a, pool), lb = loss(data, params, b, pool);
+
+    for (int i = 0; i < 40; ++i) {
+        if (la < lb) {
+            hi = b, b = a, lb = la;
+            a = hi - ratio * (hi - lo);
+            la = loss(data, params, a, pool);
+        } else {
+            lo = a, a = b, la = lb;
+            b = lo + ratio * (hi - lo);
+            lb = loss(data, params, b, pool);
+        }
+    }
+    return (lo + hi) / 2;
+}
+
+void Adam::step(Params& params, const Params& grad) {
+    ++t;
+    double correction1 = 1 - std::pow(beta1, t);
+    double correction2 = 1 - std::pow(beta2, t);
+
+    auto update = [&](double& param, double& m, double& v, double g) {
+        m = beta1 * m + (1 - beta1) * g;
+        v = beta2 * v + (1 - beta2) * g * g;
+        param -= rate * (m / correction1) / (std::sqrt(v / correction2) + epsilon);
+    };
+
+    for (int i = 0; i < N_PARAMS; ++i) {
+        update(params[i].mg, m[i].mg, v[i].mg, grad[i].mg);
+        update(params[i].eg, m[i].eg, v[i].eg, grad[i].eg);
+    }
+}
+
+void tune(const Dataset& data,
+          Params& params,
+          int epochs,
+          double rate,
+          ThreadPool& pool,
+          std::ostream& log) {
+    double k = fitK(data, params, pool);
+    log << "positions " << data.size() << " k " << k << " loss " << loss(data, params, k, pool)
+        << std::endl;
+
+    Adam adam(rate);
+    Params grad;
+    for (int epoch = 1; epoch <= epochs; ++epoch) {
+        gradient(data, params, k, pool, grad);
+        adam.step(params, grad);
+
+        if (epoch % 10 == 0 || epoch == epochs)
+            log << "epoch " << epoch << " loss " << loss(data, params, k, pool) << std::endl;
+    }
+}
+
+namespace {
+
+int rounded(double value) { return static_cast<int>(std::lround(value)); }
+
+void writeScore(std::ostream& os, const char* name, const Weight& w) {
+    os << "const Score " << name << " = makeScore(" << rounded(w.mg) << ", " << rounded(w.eg)
+       << ");\n";
+}
+
+void writeTable(std::ostream& os, const char* name, const Params& params, int pt, Phase ph) {
+    os << "constexpr ScoreArray " << name << " = {{\n";
+    for (int rank = 0; rank < 8; ++rank) {
+        os << "  ";
+        for (int file = 0; file < 8; ++file) {
+            const Weight& w = params[pieceSquareIndex(PieceType(pt), rank * 8 + file)];
+            os << std::setw(5) << rounded(ph == MIDGAME ? w.mg : w.eg) << (file < 7 ? "," : "");
+        }
+        os << (rank < 7 ? ",\n" : "\n");
+    }
+    os << "}};\n\n";
+}
+
+}  // namespace
+
+void writeHeader(std::ostream& os, const Params& params) {
+    os << "#ifndef LATRUNCULI_EVALPARAMS_H\n"
+          "#define LATRUNCULI_EVALPARAMS_H\n\n"
+          "#include \"types.hpp\"\n\n"
+          "// Tunable eval parameters, regenerated by the tune tool\n\n"
+          "namespace Eval {\n\n";
+
+    writeScore(os, "ISO_PAWN_PENALTY", params[ISO_PAWN]);
+    writeScore(os, "BACKWARD_PAWN_PENALTY", params[BACKWARD_PAWN]);
+    writeScore(os, "DOUBLED_PAWN_PENALTY", params[DOUBLED_PAWN]);
+
+    os << "\n// clang-format off\n"
+          "constexpr int pieceValueArray[N_PHASES][N_COLORS][N_PIECES] = {{\n";
+    for (Phase ph : {MIDGAME, ENDGAME}) {
+        os << (ph == MIDGAME ? "    // midgame (black, white)\n" : "    // endgame (black, white)\n");
+        for (int sign : {-1, 1}) {
+            os << "    {0";
+            for (int pt = PAWN; pt < KING; ++pt) {
+                const Weight& w = params[PIECE_VALUES + pt - PAWN];
+                os << ", " << sign * rounded(ph == MIDGAME ? w.mg : w.eg);
+            }
+            os << (sign < 0 ? ", 0},\n" : ", 0}\n");
+        }
+        os << (ph == MIDGAME ? "}, {\n" : "}};\n\n");
+    }
+
+    const char* names[6][2] = {{"pawnBonusMg", "pawnBonusEg"},
+                               {"knightBonusMg", "knightBonusEg"},
+                               {"bishopBonusMg", "bishopBonusEg"},
+                               {"rookBonusMg", "rookBonusEg"},
+                               {"queenBonusMg", "queenBonusEg"},
+                               {"kingBonusMg", "kingBonusEg"}};
+    for (int pt = PAWN; pt < N_PIECES; ++pt) {
+        writeTable(os, names[pt - PAWN][MIDGAME], params, pt, MIDGAME);
+        writeTable(os, names[pt - PAWN][ENDGAME], params, pt, ENDGAME);
+    }
+
+    os << "// clang-format on\n\n"
+          "}  // namespace Eval\n\n"
+          "#endif\n";
+}
+
+}  // namespace Tune
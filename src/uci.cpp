@@ -1,37 +1,85 @@
 #include "uci.hpp"
 
-#include <sstream>
+#include <algorithm>
+#include <charconv>
 
-#include "defs.hpp"
+#include "bench.hpp"
 #include "move.hpp"
 #include "movegen.hpp"
 #include "tt.hpp"
 
 namespace UCI {
 
+namespace {
+
+// Zero when the word isn't a number
+template <typename T>
+T number(std::string_view word) {
+  T value = 0;
+  std::from_chars(word.data(), word.data() + word.size(), value);
+  return value;
+}
+
+// Largest Hash option, in MB
+constexpr size_t MAX_HASH = 65536;
+
+// The part of the line from the start of first to the end of last
+std::string_view span(std::string_view first, std::string_view last) {
+  return std::string_view(first.data(), last.data() + last.size() - first.data());
+}
+
+}  // namespace
+
 Controller::Controller(std::istream& is, std::ostream& os)
     : chess(STARTFEN),
       search(&chess),
       _debug(false),
+      ownBook(false),
       istream(is),
-      ostream(os) {}
+      output(os),
+      positionFen(STARTFEN) {
+  search.output = &output;
+}
 
 void Controller::loop() {
   std::string line;
 
-  uci();
+  execute("uci");
 
   while (std::getline(istream, line)) {
     // Break out of the game loop if execution fails
-    if (!execute(line)) break;
+    if (!execute(line)) return;
   }
+
+  // Out of input, the last search still gets to finish
+  wait();
+}
+
+Controller::~Controller() {
+  // Before the output it writes to goes
+  search.stopThinking();
+  search.wait();
+}
+
+void Controller::wait() {
+  // Searches without limits would never finish by themselves
+  if (running.infinite || running.ponder ||
+      (!running.depth && !running.nodes && !running.movetime))
+    search.stopThinking();
+  search.wait();
+  output.flush();
 }
 
-bool Controller::execute(const std::string& input) {
-  // Split input string to get the UCI command
-  auto tokens = Defs::split(input, ' ');
-  auto cmd = tokens.at(0);
-  tokens.erase(tokens.begin());
+bool Controller::execute(std::string_view input) {
+  // Commands are parsed in place, word by word
+  Tokenizer tokens(input);
+  auto cmd = tokens.next();
+
+  // A running search carries on through the commands meant for it, any
+  // other reads or changes what it searches and waits for it to finish
+  if (cmd == "stop" || cmd == "quit" || cmd == "exit") search.stopThinking();
+  if (!cmd.empty() && cmd != "isready" && cmd != "ponderhit" && cmd != "debug" && cmd != "uci")
+    wait();
 
   if (cmd == "uci")
     uci();
@@ -40,13 +88,13 @@ bool Controller::execute(const std::string& input) {
     setdebug(tokens);
 
   else if (cmd == "isready")
-    ostream << "readyok" << std::endl;
+    reply << "readyok\n";
 
   else if (cmd == "setoption")
-    ostream << "TODO: implement uci options" << std::endl;
+    setoption(tokens);
 
   else if (cmd == "ucinewgame")
-    ostream << "TODO: clear transposition table" << std::endl;
+    search.newGame();
 
   else if (cmd == "position")
     position(tokens);
@@ -54,6 +102,11 @@ bool Controller::execute(const std::string& input) {
   else if (cmd == "go")
     go(tokens);
 
+  else if (cmd == "ponderhit") {
+    running.ponder = false;
+    search.ponderhit();
+  }
+
   else if (cmd == "move")
     move(tokens);
 
@@ -61,99 +114,198 @@ bool Controller::execute(const std::string& input) {
     moves();
 
   else if (cmd == "d")
-    ostream << chess << std::endl;
+    reply << chess << "\n";
 
   else if (cmd == "eval")
     chess.eval<true>();
 
   else if (cmd == "tt") {
-    TT::Entry* ttEntry = TT::table.probe(chess.getKey());
-    if (ttEntry) ostream << *ttEntry;
+    TT::Entry* ttEntry = search.tt.probe(chess.getKey());
+    if (ttEntry) reply << *ttEntry;
+  }
+
+  else if (cmd == "stats")
+    reply << search.stats << "\n";
+
+  else if (cmd == "bench") {
+    auto depth = tokens.next();
+    Bench::run(depth.empty() ? Bench::DEPTH : number<int>(depth), reply);
   }
 
   else if (cmd == "quit" || cmd == "exit")
     return false;
 
+  // Replies are flushed once per command rather than once per line. They
+  // go through the output thread too, so they never cut into what a
+  // running search writes.
+  output.write(reply.str());
+  reply.str("");
+  output.flush();
   return true;
 }
 
 void Controller::uci() {
   // Identify the engine
-  ostream << "id name Latrunculi 0.1.0" << std::endl;
-  ostream << "id author Eric VanderHelm" << std::endl;
-  ostream << "uciok" << std::endl;
+  reply << "id name Latrunculi 0.1.0\n";
+  reply << "id author Eric VanderHelm\n";
+  reply << "option name Hash type spin default " << TT::DEFAULT_HASH << " min 1 max " << MAX_HASH
+        << "\n";
+  reply << "option name OwnBook type check default false\n";
+  reply << "option name BookFile type string default <empty>\n";
+  reply << "uciok\n";
 }
 
-void Controller::setdebug(std::vector<std::string>& tokens) {
-  if (tokens.at(0) == "on")
+void Controller::setdebug(Tokenizer& tokens) {
+  auto mode = tokens.next();
+  if (mode == "on")
     _debug = true;
-  else if (tokens.at(0) == "off")
+  else if (mode == "off")
     _debug = false;
 }
 
-void Controller::position(std::vector<std::string>& tokens) {
-  std::string pos = tokens.at(0);
-  tokens.erase(tokens.begin());
+void Controller::setoption(Tokenizer& tokens) {
+  // setoption name <id> [value <x>], values may contain spaces
+  std::string_view name, value;
+  std::string_view* field = nullptr;
+
+  for (auto word = tokens.next(); !word.empty(); word = tokens.next()) {
+    if (word == "name")
+      field = &name;
+    else if (word == "value")
+      field = &value;
+    else if (field)
+      *field = field->empty() ? word : span(*field, word);
+  }
 
-  if (pos == "startpos") {
-    chess = Chess(STARTFEN);
-    search = Search(&chess);
+  if (name == "Hash")
+    search.tt.resize(std::clamp<size_t>(number<size_t>(value), 1, MAX_HASH));
 
-    if (_debug) ostream << chess;
-  } else if (pos == "fen") {
-    std::string fen = "";
+  else if (name == "OwnBook")
+    ownBook = value == "true";
 
-    // TODO: implement position [fen] moves ...
-    for (auto& token : tokens) {
-      if (token != "moves")
-        fen += token + " ";
-      else
-        break;
-    }
+  else if (name == "BookFile") {
+    if (value == "<empty>" || value.empty())
+      book.close();
+    else if (book.open(std::string(value)))
+      reply << "info string book " << value << " with " << book.size() << " entries\n";
+    else
+      reply << "info string could not open book " << value << "\n";
+  }
+}
 
-    chess = Chess(fen);
-    search = Search(&chess);
+void Controller::position(Tokenizer& tokens) {
+  auto pos = tokens.next();
+  auto word = tokens.next();
+  std::string_view fen;
 
-    if (_debug) ostream << chess;
-  } else {
+  if (pos == "startpos")
+    fen = STARTFEN;
+  else if (pos == "fen")
+    for (auto first = word; !word.empty() && word != "moves"; word = tokens.next())
+      fen = span(first, word);
+  else
     return;
+
+  // What's left of the line are the moves
+  Tokenizer moves = word == "moves" ? tokens : Tokenizer("");
+
+  // Moves already played from the same starting position are kept, GUIs
+  // resend the whole game every move and usually just add one or two
+  size_t common = 0;
+  if (fen == positionFen) {
+    Tokenizer played = moves;
+    for (auto move = played.next();
+         !move.empty() && common < positionMoves.size() && move == positionMoves[common];
+         move = played.next())
+      ++common;
+
+    for (size_t i = positionMoves.size(); i > common; --i) chess.unmake();
+    positionMoves.resize(common);
+  } else {
+    // Set up in place, search only keeps a pointer to chess. A FEN that
+    // doesn't parse leaves the start position.
+    if (!chess.setFromFEN(fen)) {
+      fen = STARTFEN;
+      moves = Tokenizer("");
+      chess.setFromFEN(fen);
+    }
+    positionFen = fen;
+    positionMoves.clear();
+  }
+
+  for (size_t i = 0; i < common; ++i) moves.next();
+  for (auto token = moves.next(); !token.empty(); token = moves.next()) {
+    Move move = parseMove(token);
+    if (move.isNullMove()) break;
+
+    chess.make(move);
+    positionMoves.emplace_back(token);
   }
+
+  if (_debug) reply << chess;
 }
 
-void Controller::go(std::vector<std::string>& tokens) {
-  std::string mode = tokens.at(0);
-  tokens.erase(tokens.begin());
+void Controller::go(Tokenizer& tokens) {
+  Tokenizer perft = tokens;
+  if (perft.next() == "perft") {
+    search.perft<true>(number<int>(perft.next()));
+    return;
+  }
 
-  if (mode == "perft") {
-    auto depth = std::stoi(tokens.at(0));
-    search.perft<true>(depth);
+  // Play straight from the book while in it, without searching
+  if (ownBook && book.isOpen()) {
+    Move move = book.pick(chess);
+    if (!move.isNullMove()) {
+      reply << "bestmove " << move << "\n";
+      return;
+    }
   }
 
-  else if (mode == "depth") {
-    auto depth = std::stoi(tokens.at(0));
-    search.think(depth);
+  // Parameters without a value, or that aren't used, are skipped word by
+  // word and never match a name
+  SearchLimits limits;
+  int clock = 0, increment = 0;
+  for (auto name = tokens.next(); !name.empty(); name = tokens.next()) {
+    if (name == "depth")
+      limits.depth = number<int>(tokens.next());
+    else if (name == "nodes")
+      limits.nodes = number<U64>(tokens.next());
+    else if (name == "movetime")
+      limits.movetime = number<int>(tokens.next());
+    else if (name == "infinite")
+      limits.infinite = true;
+    else if (name == "ponder")
+      limits.ponder = true;
+    else if (name == (chess.getTurn() == WHITE ? "wtime" : "btime"))
+      clock = number<int>(tokens.next());
+    else if (name == (chess.getTurn() == WHITE ? "winc" : "binc"))
+      increment = number<int>(tokens.next());
   }
+
+  // Spend a slice of the remaining clock when playing with time controls
+  if (!limits.movetime && clock > 0) limits.movetime = std::max(1, clock / 30 + increment / 2);
+
+  // Searched on a thread of its own, the loop keeps reading commands
+  running = limits;
+  search.startThinking(limits);
 }
 
-void Controller::move(std::vector<std::string>& tokens) {
-  if (tokens.at(0) == "undo") {
+void Controller::move(Tokenizer& tokens) {
+  auto word = tokens.next();
+  if (word == "undo") {
+    if (positionMoves.empty()) return;
     chess.unmake();
+    positionMoves.pop_back();
 
-    if (_debug) ostream << chess;
+    if (_debug) reply << chess;
   } else {
-    auto movegen = MoveGenerator(&chess);
-    movegen.generatePseudoLegalMoves();
+    Move move = parseMove(word);
+    if (move.isNullMove()) return;
 
-    for (auto& move : movegen.moves) {
-      std::ostringstream oss;
-      oss << move;
+    chess.make(move);
+    positionMoves.emplace_back(word);
 
-      if (oss.str() == tokens.at(0)) {
-        chess.make(move);
-
-        if (_debug) ostream << chess;
-      }
-    }
+    if (_debug) reply << chess;
   }
 }
 
@@ -161,14 +313,46 @@ void Controller::moves() {
   auto movegen = MoveGenerator(&chess);
   movegen.generatePseudoLegalMoves();
 
-  TT::Entry* entry = TT::table.probe(chess.getKey());
+  TT::Entry* entry = search.tt.probe(chess.getKey());
   if (entry)
     search.sortMoves(movegen.moves, entry->best);
   else
     search.sortMoves(movegen.moves);
 
   for (auto& move : movegen.moves)
-    ostream << move << ": " << move.score << std::endl;
+    reply << move << ": " << move.score << "\n";
+}
+
+Move Controller::parseMove(std::string_view word) {
+  // Long algebraic notation, e.g. e2e4 or e7e8q, castling as the king's move
+  if (word.size() != 4 && word.size() != 5) return Move();
+  for (int i : {0, 2})
+    if (word[i] < 'a' || word[i] > 'h' || word[i + 1] < '1' || word[i + 1] > '8') return Move();
+
+  Square from = Square((word[0] - 'a') + 8 * (word[1] - '1'));
+  Square to = Square((word[2] - 'a') + 8 * (word[3] - '1'));
+  PieceType promo = NO_PIECE_TYPE;
+  if (word.size() == 5) {
+    switch (word[4]) {
+      case 'q': promo = QUEEN; break;
+      case 'r': promo = ROOK; break;
+      case 'b': promo = BISHOP; break;
+      case 'n': promo = KNIGHT; break;
+      default: return Move();
+    }
+  }
+
+  // Looked up among the generated moves, so only legal ones come back
+  auto movegen = MoveGenerator(&chess);
+  movegen.generatePseudoLegalMoves();
+
+  for (auto& move : movegen.moves) {
+    if (move.from() != from || move.to() != to) continue;
+    if ((move.type() == PROMOTION ? move.promoPiece() : NO_PIECE_TYPE) != promo) continue;
+    if (chess.isPseudoLegalMoveLegal(move)) return move;
+  }
+
+  return Move();
 }
 
-}  // namespace UCI
\ No newline at end of file
+}  // namespace UCI
@@ -1,33 +1,72 @@
 #include "zobrist.hpp"
-#include <random>
+#include <utility>
 
 namespace Zobrist
 {
 
-    U64 psq[N_COLORS][N_PIECES][N_SQUARES];
-    U64 stm;
-    U64 ep[8];
-    U64 castle[N_COLORS][2];
-
-    void init()
+    namespace
     {
-        std::mt19937_64 r;
 
-        for (int i = 0; i < N_COLORS; i++)
-            for (int j = 0; j < N_PIECES; j++)
-                for (int k = 0; k < N_SQUARES; k++)
-                    psq[i][j][k] = r();
+        struct Cuckoo
+        {
+            std::array<U64, CUCKOO_SIZE> keys{};
+            std::array<Move, CUCKOO_SIZE> moves{};
+        };
+
+        constexpr int distance(int a, int b) { return a < b ? b - a : a - b; }
 
-        stm = r();
+        constexpr bool pseudoAttacks(PieceType pt, int s1, int s2)
+        {
+            // Whether the piece on s1 reaches s2 on an empty board
+            int dr = distance(s1 >> 3, s2 >> 3);
+            int df = distance(s1 & 7, s2 & 7);
 
-        for (int i = 0; i < 8; i++)
-            ep[i] = r();
+            switch (pt)
+            {
+                case KNIGHT: return (dr == 1 && df == 2) || (dr == 2 && df == 1);
+                case BISHOP: return dr == df;
+                case ROOK: return dr == 0 || df == 0;
+                case QUEEN: return dr == df || dr == 0 || df == 0;
+                case KING: return dr <= 1 && df <= 1;
+                default: return false;
+            }
+        }
 
-        for (int i = 0; i < N_COLORS; i++)
+        constexpr Cuckoo initCuckoo()
         {
-            castle[i][0] = r();
-            castle[i][1] = r();
+            Cuckoo table;
+
+            for (int c = 0; c < N_COLORS; c++)
+                for (int pt = KNIGHT; pt <= KING; pt++)
+                    for (int s1 = 0; s1 < N_SQUARES; s1++)
+                        for (int s2 = s1 + 1; s2 < N_SQUARES; s2++)
+                        {
+                            if (!pseudoAttacks(PieceType(pt), s1, s2))
+                                continue;
+
+                            // Insert, kicking out whatever sits in the slot
+                            // to its other location until a free slot is hit
+                            Move move = Move(Square(s1), Square(s2));
+                            U64 key = psq[c][pt][s1] ^ psq[c][pt][s2] ^ stm;
+                            int i = cuckooH1(key);
+                            while (true)
+                            {
+                                std::swap(table.keys[i], key);
+                                std::swap(table.moves[i], move);
+                                if (move.isNullMove())
+                                    break;
+                                i = (i == cuckooH1(key)) ? cuckooH2(key) : cuckooH1(key);
+                            }
+                        }
+
+            return table;
         }
+
+        constexpr Cuckoo table = initCuckoo();
+
     }
 
-}
\ No newline at end of file
+    constexpr std::array<U64, CUCKOO_SIZE> cuckoo = table.keys;
+    constexpr std::array<Move, CUCKOO_SIZE> cuckooMove = table.moves;
+
+}
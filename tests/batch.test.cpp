@@ -0,0 +1,85 @@
+#include "batch.hpp"
+
+#include <gtest/gtest.h>
+
+#include "bench.hpp"
+#include "chess.hpp"
+#include "constants.hpp"
+#include "movegen.hpp"
+
+class BatchTest : public ::testing::Test {
+   protected:
+    BoardBatch batch;
+    std::vector<Chess> positions;
+
+    void SetUp() override {
+        // The perft positions two plies deep cover checks, pins, en passant
+        // and castling, the bench positions one ply deep middlegames
+        for (auto& fen : FENS) collect(Chess(fen), 2);
+        for (auto fen : Bench::POSITIONS) collect(Chess(fen), 1);
+
+        // En passant exposing the king along the rank, and taking a checker
+        collect(Chess("8/8/8/KPp4r/8/8/8/7k w - c6 0 1"), 0);
+        collect(Chess("8/8/8/2k5/3Pp3/8/8/4K3 b - d3 0 1"), 0);
+
+        for (auto& chess : positions) batch.add(chess);
+    }
+
+    void collect(Chess chess, int depth) {
+        positions.push_back(chess);
+        if (depth == 0) return;
+
+        MoveGenerator movegen(&chess);
+        movegen.generatePseudoLegalMoves();
+        for (auto& move : movegen.moves) {
+            if (!chess.isPseudoLegalMoveLegal(move)) continue;
+            chess.make(move);
+            collect(chess, depth - 1);
+            chess.unmake();
+        }
+    }
+};
+
+TEST_F(BatchTest, CountMovesMatchesMoveGenerator) {
+    ASSERT_EQ(batch.size(), positions.size());
+    std::vector<U32> pseudoLegal(batch.size()), legal(batch.size());
+    batch.countMoves(pseudoLegal.data(), legal.data());
+
+    for (size_t i = 0; i < positions.size(); ++i) {
+        MoveGenerator movegen(&positions[i]);
+        movegen.generatePseudoLegalMoves();
+        U32 legalMoves = 0;
+        for (auto& move : movegen.moves) legalMoves += positions[i].isPseudoLegalMoveLegal(move);
+
+        ASSERT_EQ(pseudoLegal[i], movegen.moves.size()) << positions[i].toFEN();
+        ASSERT_EQ(legal[i], legalMoves) << positions[i].toFEN();
+    }
+}
+
+TEST_F(BatchTest, AttacksMatchBoard) {
+    std::vector<U64> attacks(batch.size());
+    for (Color c : {WHITE, BLACK}) {
+        batch.attacks(c, attacks.data());
+        for (size_t i = 0; i < positions.size(); ++i) {
+            Board board(positions[i].toFEN());
+            U64 expected = 0;
+            for (int sq = A1; sq <= H8; ++sq)
+                if (board.attacksTo(Square(sq), c)) expected |= BB::set(Square(sq));
+            ASSERT_EQ(attacks[i], expected) << positions[i].toFEN();
+        }
+    }
+}
+
+TEST_F(BatchTest, PartialRegister) {
+    // Padding lanes of a batch that doesn't fill its last register stay out
+    BoardBatch small;
+    small.add(Chess(STARTFEN));
+    small.add(Chess(POS2));
+    std::vector<U32> pseudoLegal(2), legal(2);
+    small.countMoves(pseudoLegal.data(), legal.data());
+    EXPECT_EQ(legal[0], 20);
+    EXPECT_EQ(legal[1], 48);
+
+    small.clear();
+    EXPECT_EQ(small.size(), 0);
+}
@@ -117,3 +117,33 @@ TEST(BitboardTest, FillSouth) {
     EXPECT_EQ(BB::fillSouth(BB::set(A2)), BB::set(A2) | BB::set(A1)) << "should fill bits";
     EXPECT_EQ(BB::fillSouth(BB::set(H2)), BB::set(H2) | BB::set(H1)) << "should fill bits";
 }
+
+TEST(BitboardTest, SlidingAttacks) {
+    // Setwise attacks agree with looking up every slider on its own
+    U64 x = 0x9E3779B97F4A7C15ULL;
+    auto next = [&x] {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        return x;
+    };
+
+    for (int i = 0; i < 10000; ++i) {
+        U64 occ = next() & next();
+        U64 rooks = occ & next() & next(), bishops = occ & next() & next() & ~rooks;
+
+        U64 rookAttacks = 0, bishopAttacks = 0;
+        for (U64 b = rooks; b; b &= b - 1) rookAttacks |= BB::movesByPiece<ROOK>(BB::lsb(b), occ);
+        for (U64 b = bishops; b; b &= b - 1)
+            bishopAttacks |= BB::movesByPiece<BISHOP>(BB::lsb(b), occ);
+
+        ASSERT_EQ(BB::attacksBySliders<ROOK>(rooks, occ), rookAttacks);
+        ASSERT_EQ(BB::attacksBySliders<BISHOP>(bishops, occ), bishopAttacks);
+        ASSERT_EQ(BB::slidingAttacks(rooks, bishops, occ), rookAttacks | bishopAttacks);
+    }
+
+    // One direction stops on the first blocker, taking it in
+    EXPECT_EQ(BB::occludedFill<8>(BB::set(A1), ~0ull), BB::FILE_MASK[FILE1] & ~BB::set(A1));
+    EXPECT_EQ(BB::occludedFill<9>(BB::set(A1), ~BB::set(C3)), BB::set(B2) | BB::set(C3));
+    EXPECT_EQ(BB::occludedFill<-1>(BB::set(A1), ~0ull), 0);
+}
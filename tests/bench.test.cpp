@@ -0,0 +1,25 @@
+#include "bench.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "chess.hpp"
+
+class BenchTest : public ::testing::Test {};
+
+TEST_F(BenchTest, PositionsRoundTrip) {
+    for (auto fen : Bench::POSITIONS) EXPECT_EQ(Chess(fen).toFEN(), fen);
+}
+
+TEST_F(BenchTest, Deterministic) {
+    // Nothing left over from one run may change the next
+    std::ostringstream first, second;
+    auto a = Bench::run(2, first);
+    auto b = Bench::run(2, second);
+    EXPECT_GT(a.nodes, 0);
+    EXPECT_EQ(a.nodes, b.nodes);
+
+    std::string last = first.str().substr(first.str().rfind("nodes"));
+    EXPECT_EQ(last.substr(0, last.find(" time")), "nodes " + std::to_string(a.nodes));
+}
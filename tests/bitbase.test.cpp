@@ -0,0 +1,115 @@
+#include "bitbase.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "chess.hpp"
+#include "movegen.hpp"
+
+class BitbaseTest : public ::testing::Test {
+   protected:
+    static void SetUpTestSuite() { Bitbases::init(); }
+};
+
+namespace {
+
+std::string kpkFEN(Square whiteKing, Square pawn, Square blackKing, Color stm) {
+    std::string fen;
+    for (int rank = RANK8; rank >= RANK1; --rank) {
+        int empty = 0;
+        for (int file = FILE1; file <= FILE8; ++file) {
+            Square sq = Defs::sqFromCoords(File(file), Rank(rank));
+            char piece = sq == whiteKing ? 'K' : sq == blackKing ? 'k' : sq == pawn ? 'P' : 0;
+            if (!piece) {
+                ++empty;
+                continue;
+            }
+            if (empty) fen += std::to_string(empty);
+            fen += piece;
+            empty = 0;
+        }
+        if (empty) fen += std::to_string(empty);
+        if (rank > RANK1) fen += '/';
+    }
+    return fen + (stm == WHITE ? " w" : " b") + " - - 0 1";
+}
+
+}  // namespace
+
+TEST_F(BitbaseTest, KnownResults) {
+    // pawn runs, black king outside the square
+    EXPECT_TRUE(Bitbases::probeKPK(E1, A5, H8, WHITE));
+    EXPECT_FALSE(Bitbases::probeKPK(E1, A5, C8, BLACK));
+
+    // rook pawn, defending king in the corner
+    EXPECT_FALSE(Bitbases::probeKPK(A1, A2, A8, WHITE));
+    EXPECT_FALSE(Bitbases::probeKPK(H1, H2, H8, BLACK));
+
+    // white king on a key square wins with either side to move
+    EXPECT_TRUE(Bitbases::probeKPK(E6, E4, E8, WHITE));
+    EXPECT_TRUE(Bitbases::probeKPK(E6, E4, E8, BLACK));
+    EXPECT_TRUE(Bitbases::probeKPK(D6, D4, D8, BLACK));
+
+    // defending king blockades a pawn that got ahead of its king
+    EXPECT_FALSE(Bitbases::probeKPK(E5, E6, E8, WHITE));
+    EXPECT_FALSE(Bitbases::probeKPK(E5, E6, E8, BLACK));
+
+    // black to move takes the undefended pawn
+    EXPECT_FALSE(Bitbases::probeKPK(A1, D4, E5, BLACK));
+}
+
+TEST_F(BitbaseTest, WinCount) {
+    int wins = 0;
+    for (Color stm : {WHITE, BLACK})
+        for (int pawn = A2; pawn <= H7; ++pawn)
+            for (int wk = A1; wk < N_SQUARES; ++wk)
+                for (int bk = A1; bk < N_SQUARES; ++bk)
+                    if (Defs::fileFromSq(Square(pawn)) <= FILE4)
+                        wins += Bitbases::probeKPK(Square(wk), Square(pawn), Square(bk), stm);
+    EXPECT_EQ(wins, 111282);
+}
+
+TEST_F(BitbaseTest, ConsistentWithMoveGenerator) {
+    // Every sampled position's result must follow from its children, using
+    // the engine's own move generator rather than the bitbase's move logic
+    int checked = 0;
+    for (int n = 0; n < 2 * 48 * 64 * 64; n += 37) {
+        Square whiteKing = Square(n & 63);
+        Square blackKing = Square((n >> 6) & 63);
+        Square pawn = Square(A2 + (n >> 12) % 48);
+        Color stm = Color(n / (48 * 64 * 64));
+
+        if (BB::DISTANCE[whiteKing][blackKing] <= 1 || whiteKing == pawn || blackKing == pawn)
+            continue;
+        if (stm == WHITE && (BB::attacksByPawns<WHITE>(BB::set(pawn)) & BB::set(blackKing)))
+            continue;
+        if (Defs::rankFromSq(pawn) == RANK7) continue;
+
+        Chess chess(kpkFEN(whiteKing, pawn, blackKing, stm));
+        MoveGenerator movegen(&chess);
+        movegen.generatePseudoLegalMoves();
+
+        bool anyWin = false, allWin = true, anyMove = false;
+        for (auto& move : movegen.moves) {
+            if (!chess.isPseudoLegalMoveLegal(move)) continue;
+            anyMove = true;
+
+            // Black capturing the pawn is a draw
+            Square to = move.to();
+            Square wk = move.from() == whiteKing ? to : whiteKing;
+            Square bk = move.from() == blackKing ? to : blackKing;
+            Square p = move.from() == pawn ? to : pawn;
+            bool win = bk != pawn && Bitbases::probeKPK(wk, p, bk, ~stm);
+
+            anyWin |= win;
+            allWin &= win;
+        }
+
+        bool expected = stm == WHITE ? anyWin : anyMove && allWin;
+        EXPECT_EQ(Bitbases::probeKPK(whiteKing, pawn, blackKing, stm), expected)
+            << kpkFEN(whiteKing, pawn, blackKing, stm);
+        ++checked;
+    }
+    EXPECT_GT(checked, 3000);
+}
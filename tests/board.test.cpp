@@ -7,7 +7,6 @@
 class BoardTest : public ::testing::Test {
    protected:
     void SetUp() override {
-        Magics::init();
         emptyBoard = new Board("4k3/8/8/8/8/8/8/4K3 w - - 0 1");
         startBoard = new Board(STARTFEN);
         pinBoard = new Board(POS3);
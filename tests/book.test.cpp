@@ -0,0 +1,170 @@
+#include "book.hpp"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "chess.hpp"
+#include "constants.hpp"
+
+class BookTest : public ::testing::Test {
+   protected:
+    std::filesystem::path path;
+
+    void SetUp() override {
+        path = std::filesystem::temp_directory_path() / "latrunculi_book_test.bin";
+    }
+
+    void TearDown() override { std::filesystem::remove(path); }
+
+    static Chess play(const std::string& moves) {
+        Chess chess(STARTFEN);
+        std::istringstream iss(moves);
+        std::string san;
+        while (iss >> san) {
+            Move move = Book::parseSAN(chess, san);
+            EXPECT_FALSE(move.isNullMove()) << san;
+            chess.make(move);
+        }
+        return chess;
+    }
+};
+
+namespace {
+
+const char* PGN =
+    "[Event \"A\"]\n"
+    "[Result \"1-0\"]\n"
+    "\n"
+    "1. e4 e5 2. Nf3 {main line} Nc6 3. Bc4 (3. Bb5 a6) Bc5 4. O-O 1-0\n"
+    "\n"
+    "[Event \"B\"]\n"
+    "[Result \"1/2-1/2\"]\n"
+    "\n"
+    "1.e4 c5 2.Nf3 d6 $1 1/2-1/2\n"
+    "\n"
+    "[Event \"C\"]\n"
+    "[Result \"0-1\"]\n"
+    "\n"
+    "1. d4 d5 0-1\n";
+
+}  // namespace
+
+TEST_F(BookTest, PolyglotKeyTranspositions) {
+    // The en passant square only matters if a pawn can take on it
+    EXPECT_EQ(play("e4 e5 Nf3").calculatePolyglotKey(),
+              play("Nf3 e5 e4").calculatePolyglotKey());
+    EXPECT_NE(play("e4 e5 Nf3").calculatePolyglotKey(),
+              play("e4 e5 Nf3 Nf6").calculatePolyglotKey());
+
+    Chess ep = play("e4 Nf6 e5 d5");
+    Chess noEp("rnbqkb1r/ppp1pppp/5n2/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq - 0 3");
+    EXPECT_NE(ep.calculatePolyglotKey(), noEp.calculatePolyglotKey());
+    EXPECT_EQ(Chess("rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq e6 0 2")
+                  .calculatePolyglotKey(),
+              Chess("rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 2")
+                  .calculatePolyglotKey());
+}
+
+TEST_F(BookTest, PolyglotReferenceKeys) {
+    // Test vectors of the Polyglot book format description
+    EXPECT_EQ(Chess(STARTFEN).calculatePolyglotKey(), 0x463B96181691FC9CULL);
+    EXPECT_EQ(play("e4").calculatePolyglotKey(), 0x823C9B50FD114196ULL);
+    EXPECT_EQ(play("e4 d5").calculatePolyglotKey(), 0x0756B94461C50FB0ULL);
+    EXPECT_EQ(play("e4 d5 e5").calculatePolyglotKey(), 0x662FAFB965DB29D4ULL);
+    EXPECT_EQ(play("e4 d5 e5 f5").calculatePolyglotKey(), 0x22A48B5A8E47FF78ULL);
+    EXPECT_EQ(play("e4 d5 e5 f5 Ke2").calculatePolyglotKey(), 0x652A607CA3F242C1ULL);
+    EXPECT_EQ(play("e4 d5 e5 f5 Ke2 Kf7").calculatePolyglotKey(), 0x00FDD303C946BDD9ULL);
+    EXPECT_EQ(play("a4 b5 h4 b4 c4").calculatePolyglotKey(), 0x3C8123EA7B067637ULL);
+    EXPECT_EQ(play("a4 b5 h4 b4 c4 bxc3 Ra3").calculatePolyglotKey(), 0x5C3F9B829B279560ULL);
+}
+
+TEST_F(BookTest, ParseSAN) {
+    Chess chess("r3k2r/1P6/8/8/8/8/8/R3K1NR w KQkq - 0 1");
+    EXPECT_EQ(Book::parseSAN(chess, "O-O-O"), Move(E1, C1, CASTLE));
+    EXPECT_EQ(Book::parseSAN(chess, "bxa8=Q+"), Move(B7, A8, PROMOTION, QUEEN));
+    EXPECT_EQ(Book::parseSAN(chess, "b8=N"), Move(B7, B8, PROMOTION, KNIGHT));
+    EXPECT_EQ(Book::parseSAN(chess, "Nf3"), Move(G1, F3));
+    EXPECT_EQ(Book::parseSAN(chess, "Rb1"), Move(A1, B1));
+    EXPECT_TRUE(Book::parseSAN(chess, "O-O").isNullMove());
+    EXPECT_TRUE(Book::parseSAN(chess, "Ke3").isNullMove());
+
+    Chess knights("4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1");
+    EXPECT_EQ(Book::parseSAN(knights, "Nbd2"), Move(B1, D2));
+    EXPECT_EQ(Book::parseSAN(knights, "Nfd2"), Move(F1, D2));
+    EXPECT_TRUE(Book::parseSAN(knights, "Nd2").isNullMove());
+}
+
+TEST_F(BookTest, MoveEncoding) {
+    // Castling is the king taking its own rook
+    EXPECT_EQ(Book::encodeMove(Move(E1, G1, CASTLE)), H1 | E1 << 6);
+    EXPECT_EQ(Book::encodeMove(Move(E8, C8, CASTLE)), A8 | E8 << 6);
+    EXPECT_EQ(Book::encodeMove(Move(B7, A8, PROMOTION, QUEEN)), A8 | B7 << 6 | 4 << 12);
+
+    Chess chess("r3k2r/1P6/8/8/8/8/8/R3K1NR w KQkq - 0 1");
+    for (auto move : {Move(E1, C1, CASTLE), Move(B7, A8, PROMOTION, ROOK), Move(G1, F3)})
+        EXPECT_EQ(Book::decodeMove(chess, Book::encodeMove(move)), move);
+    EXPECT_TRUE(Book::decodeMove(chess, Book::encodeMove(Move(E1, G1, CASTLE))).isNullMove());
+}
+
+TEST_F(BookTest, BuildAndProbe) {
+    std::istringstream pgn(PGN);
+    auto entries = Book::fromPGN(pgn, 20);
+    ASSERT_TRUE(Book::write(path.string(), entries));
+
+    Book::Reader reader;
+    ASSERT_TRUE(reader.open(path.string()));
+    EXPECT_EQ(reader.size(), entries.size());
+
+    // 1. e4 scored a win and a draw, 1. d4 only lost
+    Chess chess(STARTFEN);
+    auto start = reader.probe(chess.calculatePolyglotKey());
+    ASSERT_EQ(start.size(), 1);
+    EXPECT_EQ(start[0].weight, 3);
+    EXPECT_EQ(reader.pick(chess, true), Move(E2, E4));
+    EXPECT_EQ(reader.pick(chess), Move(E2, E4));
+
+    // Black's replies after 1. e4, only the draw scored for black
+    Chess e4 = play("e4");
+    auto replies = reader.probe(e4.calculatePolyglotKey());
+    ASSERT_EQ(replies.size(), 1);
+    EXPECT_EQ(reader.pick(e4), Move(C7, C5));
+
+    // Variations stay out of the book, castling comes back as a castle move
+    EXPECT_TRUE(reader.probe(play("e4 e5 Nf3 Nc6 Bb5").calculatePolyglotKey()).empty());
+    Chess castle = play("e4 e5 Nf3 Nc6 Bc4 Bc5");
+    EXPECT_EQ(reader.pick(castle), Move(E1, G1, CASTLE));
+
+    Chess outOfBook = play("a4");
+    EXPECT_TRUE(reader.pick(outOfBook).isNullMove());
+}
+
+TEST_F(BookTest, OpenFailure) {
+    Book::Reader reader;
+    EXPECT_FALSE(reader.open("/nonexistent/book.bin"));
+    EXPECT_FALSE(reader.isOpen());
+    Chess chess(STARTFEN);
+    EXPECT_TRUE(reader.pick(chess).isNullMove());
+}
+
+TEST_F(BookTest, CloseUnmapsTrailingPage) {
+    // 256 entries and a stray byte, the byte alone on a second page
+    {
+        std::ofstream os(path, std::ios::binary);
+        std::string bytes(256 * Book::ENTRY_SIZE + 1, '\0');
+        os.write(bytes.data(), bytes.size());
+    }
+
+    Book::Reader reader;
+    ASSERT_TRUE(reader.open(path.string()));
+    EXPECT_EQ(reader.size(), 256);
+    reader.close();
+
+    std::ifstream maps("/proc/self/maps");
+    std::string line;
+    while (std::getline(maps, line))
+        EXPECT_EQ(line.find(path.filename().string()), std::string::npos) << line;
+}
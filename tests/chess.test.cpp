@@ -3,57 +3,106 @@
 #include <gtest/gtest.h>
 
 #include <memory>
+#include <set>
 #include <string>
 
+#include "bench.hpp"
 #include "constants.hpp"
 #include "eval.hpp"
 #include "zobrist.hpp"
 
-class ChessTest : public ::testing::Test {
-   protected:
-    void SetUp() override { Magics::init(); }
-};
+class ChessTest : public ::testing::Test {};
 
 TEST_F(ChessTest, PawnsEvalIsoPawn) {
     Chess c(E2PAWN);
-    auto [mg, eg] = c.pawnsEval();
-    EXPECT_LT(mg, 0) << "midgame evaluation should penalize iso pawns";
-    EXPECT_LT(eg, 0) << "endgame evaluation should penalize iso pawns";
+    Score score = c.pawnsEval();
+    EXPECT_LT(mgValue(score), 0) << "midgame evaluation should penalize iso pawns";
+    EXPECT_LT(egValue(score), 0) << "endgame evaluation should penalize iso pawns";
 }
 
 TEST_F(ChessTest, PawnsEvalBackwardsPawn) {
     Chess c("4k3/8/1pp5/1P6/P7/8/8/4K3 w - - 0 1");
-    auto [mg, eg] = c.pawnsEval();
-    EXPECT_LT(mg, 0) << "midgame evaluation should penalize backwards pawns";
-    EXPECT_LT(eg, 0) << "endgame evaluation should penalize backwards pawns";
+    Score score = c.pawnsEval();
+    EXPECT_LT(mgValue(score), 0) << "midgame evaluation should penalize backwards pawns";
+    EXPECT_LT(egValue(score), 0) << "endgame evaluation should penalize backwards pawns";
 }
 
 TEST_F(ChessTest, PawnsEvalDoubledPawn) {
     Chess c("4k3/8/8/8/P7/P7/8/4K3 w - - 0 1");
-    auto [mg, eg] = c.pawnsEval();
-    EXPECT_LT(mg, 0) << "midgame evaluation should penalize doubled pawns";
-    EXPECT_LT(eg, 0) << "endgame evaluation should penalize doubled pawns";
+    Score score = c.pawnsEval();
+    EXPECT_LT(mgValue(score), 0) << "midgame evaluation should penalize doubled pawns";
+    EXPECT_LT(egValue(score), 0) << "endgame evaluation should penalize doubled pawns";
 }
 
 TEST_F(ChessTest, EvalStartBoard) {
     Chess c(STARTFEN);
-    int mg = c.phaseEval<MIDGAME>(0, 0);
+    int mg = c.phaseEval<MIDGAME>(SCORE_ZERO);
     EXPECT_EQ(c.eval<false>(), mg + Eval::TEMPO_BONUS)
         << "start board eval should equal midgame eval + tempo";
 }
 
 TEST_F(ChessTest, EvalEmptyBoard) {
     Chess c(EMPTYFEN);
-    int eg = c.phaseEval<ENDGAME>(0, 0);
+    int eg = c.phaseEval<ENDGAME>(SCORE_ZERO);
     EXPECT_EQ(c.eval<false>(), eg + Eval::TEMPO_BONUS)
         << "empty board eval should equal endgame eval + tempo";
 }
 
+TEST_F(ChessTest, PiecesEvalMobility) {
+    Chess c("n3k3/8/8/8/3N4/8/8/4K3 w - - 0 1");
+    Eval::EvalInfo info;
+    c.initEvalInfo(info);
+    Score score = c.piecesEval(info);
+    EXPECT_GT(mgValue(score), 0) << "midgame evaluation should reward mobile pieces";
+    EXPECT_GT(egValue(score), 0) << "endgame evaluation should reward mobile pieces";
+}
+
+TEST_F(ChessTest, PiecesEvalRookOpenFile) {
+    Chess c("r3k3/p7/8/8/8/8/6P1/3RK3 w - - 0 1");
+    Eval::EvalInfo info;
+    c.initEvalInfo(info);
+    Score score = c.piecesEval(info);
+    EXPECT_GT(mgValue(score), 0) << "midgame evaluation should prefer the rook on the open file";
+    EXPECT_GT(egValue(score), 0) << "endgame evaluation should prefer the rook on the open file";
+}
+
+TEST_F(ChessTest, PiecesEvalAttackMaps) {
+    Chess c(POS2);
+    Eval::EvalInfo info;
+    c.initEvalInfo(info);
+    c.piecesEval(info);
+
+    U64 occ = Board(POS2).occupancy();
+    U64 expected = BB::attacksByPawns<WHITE>(Board(POS2).getPieces<PAWN>(WHITE)) |
+                   BB::movesByPiece<KING>(E1);
+    for (Square sq : {C3, E5, D2, E2, A1, H1, F3}) {
+        expected |= BB::movesByPiece(sq, Board(POS2).getPieceType(sq), occ);
+    }
+    EXPECT_EQ(info.attackedBy[WHITE][ALL_PIECES], expected)
+        << "attack pass should cover every white piece";
+    EXPECT_EQ(info.attackedBy[WHITE][QUEEN], BB::movesByPiece<QUEEN>(F3, occ));
+}
+
+TEST_F(ChessTest, KingEvalDanger) {
+    Chess c("6k1/5ppp/8/6NQ/8/8/5PPP/6K1 w - - 0 1");
+    Eval::EvalInfo info;
+    c.initEvalInfo(info);
+    c.piecesEval(info);
+    EXPECT_EQ(info.kingAttackersCount[WHITE], 2) << "queen and knight attack the king zone";
+    EXPECT_EQ(info.kingAttackersCount[BLACK], 0);
+
+    Score score = c.kingEval(info);
+    EXPECT_GT(mgValue(score), 0) << "midgame evaluation should penalize the attacked king";
+}
+
 TEST_F(ChessTest, EvalBlackToMove) {
     Chess c(POS4B);
-    auto [mgPawns, egPawns] = c.pawnsEval();
-    auto [mgPieces, egPieces] = c.pawnsEval();
-    int score = -c.phaseEval<MIDGAME>(mgPawns, mgPieces);
+    Eval::EvalInfo info;
+    c.initEvalInfo(info);
+    Score terms = c.pawnsEval();
+    terms += c.piecesEval(info);
+    terms += c.kingEval(info);
+    int score = -c.phaseEval<MIDGAME>(terms);
 
     EXPECT_EQ(c.eval<false>(), score + Eval::TEMPO_BONUS)
         << "black to move should invert eval";
@@ -87,6 +136,20 @@ TEST_F(ChessTest, MidGamePieceSqBonus) {
     EXPECT_EQ(Chess(E2PAWN).pieceSqScore<MIDGAME>(), Eval::pieceSqBonus(MIDGAME, WHITE, PAWN, E2));
 }
 
+TEST_F(ChessTest, PsqScore) {
+    for (auto fen : FENS) {
+        Chess c = Chess(fen);
+        EXPECT_EQ(mgValue(c.psqScore()), c.materialScore<MIDGAME>() + c.pieceSqScore<MIDGAME>());
+        EXPECT_EQ(egValue(c.psqScore()), c.materialScore<ENDGAME>() + c.pieceSqScore<ENDGAME>());
+    }
+
+    Chess c = Chess(POS2);
+    Score score = c.psqScore();
+    c.make(Move(E2, A6));
+    c.unmake();
+    EXPECT_EQ(c.psqScore(), score) << "should restore the psq score on undo";
+}
+
 TEST_F(ChessTest, EndGamePieceSqBonus) {
     EXPECT_EQ(Chess(STARTFEN).pieceSqScore<ENDGAME>(), 0);
     EXPECT_EQ(Chess(EMPTYFEN).pieceSqScore<ENDGAME>(), 0);
@@ -110,6 +173,12 @@ TEST_F(ChessTest, ScaleFactor) {
     EXPECT_EQ(Chess(STARTFEN).scaleFactor(), 64);
 }
 
+TEST_F(ChessTest, EndgamePhaseEvalScaled) {
+    Chess c("3qk3/8/8/8/8/8/8/3BK3 w - - 0 1");
+    EXPECT_EQ(c.phaseEval<ENDGAME>(SCORE_ZERO), egValue(c.psqScore()) * 40 / 64)
+        << "scale factors below 64 scale the endgame score, not zero it";
+}
+
 TEST_F(ChessTest, Make) {
     Chess c = Chess(STARTFEN);
     c.make(Move(G1, F3));
@@ -385,3 +454,147 @@ TEST_F(ChessTest, ChessToFEN) {
         EXPECT_EQ(c.toFEN(), fen) << "should return identical fen";
     }
 }
+
+namespace {
+
+void play(Chess& c, std::initializer_list<Move> moves) {
+    for (auto move : moves) c.make(move);
+}
+
+}  // namespace
+
+TEST_F(ChessTest, Repetition) {
+    Chess c(STARTFEN);
+    play(c, {Move(G1, F3), Move(G8, F6), Move(F3, G1), Move(F6, G8)});
+
+    // Repeated once: a draw inside the search tree, not yet before the root
+    EXPECT_TRUE(c.isRepetition(5));
+    EXPECT_FALSE(c.isRepetition(4));
+    EXPECT_FALSE(c.isDraw(0));
+
+    play(c, {Move(G1, F3), Move(G8, F6), Move(F3, G1), Move(F6, G8)});
+    EXPECT_TRUE(c.isRepetition(0));
+    EXPECT_TRUE(c.isDraw(0));
+
+    // Irreversible moves cut the scan short
+    play(c, {Move(E2, E4), Move(G8, F6), Move(G1, F3), Move(F6, G8)});
+    EXPECT_FALSE(c.isRepetition(8));
+}
+
+TEST_F(ChessTest, RepetitionInLongGame) {
+    // Well over 256 plies without a null move still finds the repetition
+    Chess c(STARTFEN);
+    for (int i = 0; i < 63; ++i)
+        play(c, {Move(G1, F3), Move(G8, F6), Move(F3, G1), Move(F6, G8)});
+    play(c, {Move(A2, A3), Move(A7, A6)});
+    play(c, {Move(G1, F3), Move(G8, F6), Move(F3, G1), Move(F6, G8)});
+    EXPECT_TRUE(c.isRepetition(5));
+    EXPECT_TRUE(c.hasUpcomingRepetition(4));
+}
+
+TEST_F(ChessTest, RepetitionNotAcrossNullMove) {
+    Chess c(STARTFEN);
+    play(c, {Move(G1, F3), Move(G8, F6)});
+    c.makeNull();
+    play(c, {Move(F6, G8), Move(F3, G1)});
+    c.makeNull();
+    EXPECT_FALSE(c.isRepetition(6));
+    EXPECT_FALSE(c.hasUpcomingRepetition(6));
+}
+
+TEST_F(ChessTest, FiftyMoveRule) {
+    EXPECT_TRUE(Chess("4k3/8/8/8/8/8/8/R3K3 b - - 100 80").isDraw(0));
+    EXPECT_FALSE(Chess("4k3/8/8/8/8/8/8/R3K3 b - - 99 80").isDraw(0));
+    EXPECT_FALSE(Chess("R3k3/8/8/8/8/8/8/4K3 b - - 100 80").isDraw(0))
+        << "a check on the hundredth ply may be mate, left for the search";
+}
+
+TEST_F(ChessTest, ZobristKeys) {
+    // Compile time keys, all distinct and nonzero
+    std::set<U64> keys{Zobrist::stm};
+    for (int c = BLACK; c < N_COLORS; ++c) {
+        for (int pt = PAWN; pt <= KING; ++pt)
+            for (int sq = A1; sq <= H8; ++sq) keys.insert(Zobrist::psq[c][pt][sq]);
+        keys.insert(Zobrist::castle[c].begin(), Zobrist::castle[c].end());
+    }
+    keys.insert(Zobrist::ep.begin(), Zobrist::ep.end());
+    EXPECT_EQ(keys.size(), 2 * 6 * 64 + 1 + 2 * 2 + 8);
+    EXPECT_FALSE(keys.count(0));
+
+    static_assert(Zobrist::psq[WHITE][PAWN][E2] != Zobrist::psq[WHITE][PAWN][E4]);
+}
+
+TEST_F(ChessTest, CuckooTable) {
+    int count = 0;
+    for (int i = 0; i < Zobrist::CUCKOO_SIZE; ++i) count += !Zobrist::cuckooMove[i].isNullMove();
+    EXPECT_EQ(count, 3668) << "every reversible piece move for both colors";
+}
+
+TEST_F(ChessTest, UpcomingRepetition) {
+    Chess c(STARTFEN);
+    play(c, {Move(G1, F3), Move(G8, F6), Move(F3, G1)});
+
+    // Nf6-g8 goes back to the start position, three plies ago
+    EXPECT_TRUE(c.hasUpcomingRepetition(4));
+    EXPECT_FALSE(c.hasUpcomingRepetition(3));
+
+    play(c, {Move(B8, C6)});
+    EXPECT_FALSE(c.hasUpcomingRepetition(8));
+}
+
+TEST_F(ChessTest, SetFromFEN) {
+    // Loaded over a game in progress, into the same position every time
+    Chess c(STARTFEN);
+    play(c, {Move(G1, F3), Move(G8, F6)});
+
+    std::vector<std::string> fens(std::begin(FENS), std::end(FENS));
+    fens.insert(fens.end(), Bench::POSITIONS.begin(), Bench::POSITIONS.end());
+    for (auto& fen : fens) {
+        ASSERT_TRUE(c.setFromFEN(fen)) << fen;
+        Board board(fen);
+        for (int sq = A1; sq <= H8; ++sq)
+            EXPECT_EQ(c.getPiece(Square(sq)), board.getPiece(Square(sq))) << fen;
+        EXPECT_EQ(c.getKey(), c.calculateKey()) << fen;
+        EXPECT_EQ(c.getMaterialKey(), board.materialKey) << fen;
+
+        std::string written = c.toFEN();
+        ASSERT_TRUE(c.setFromFEN(written));
+        EXPECT_EQ(c.toFEN(), written);
+    }
+
+    for (auto& fen : FENS) {
+        c.setFromFEN(fen);
+        EXPECT_EQ(c.toFEN(), fen);
+    }
+}
+
+TEST_F(ChessTest, SetFromFENWithoutClocks) {
+    Chess c(STARTFEN);
+    EXPECT_TRUE(c.setFromFEN("4k3/8/8/8/8/8/8/4K3 b - -"));
+    EXPECT_EQ(c.toFEN(), "4k3/8/8/8/8/8/8/4K3 b - - 0 1");
+}
+
+TEST_F(ChessTest, SetFromFENRejectsMalformed) {
+    Chess c(STARTFEN);
+    for (auto fen : {"",
+                     "rnbqkbnr/ppppxppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+                     "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR x KQkq - 0 1",
+                     "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq",
+                     "8/8/8/8/8/8/8/8/8/k7 w - - 0 1",
+                     "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq e9 0 1"})
+        EXPECT_FALSE(c.setFromFEN(fen)) << fen;
+
+    EXPECT_THROW(Chess("8/8/8 w"), std::invalid_argument);
+}
+
+TEST_F(ChessTest, ToFENBuffer) {
+    // Every square taken and the longest clocks fill the buffer exactly
+    std::string fen =
+        "rnbqkbnr/pppppppp/pppppppp/pppppppp/PPPPPPPP/PPPPPPPP/PPPPPPPP/RNBQKBNR b KQkq e3 100 "
+        "2147483648";
+    ASSERT_EQ(fen.size(), Chess::MAX_FEN);
+
+    char buffer[Chess::MAX_FEN];
+    Chess c(fen);
+    EXPECT_EQ(std::string(buffer, c.toFEN(buffer)), fen);
+}
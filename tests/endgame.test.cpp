@@ -0,0 +1,70 @@
+#include "endgame.hpp"
+
+#include <gtest/gtest.h>
+
+#include "bitbase.hpp"
+#include "chess.hpp"
+#include "constants.hpp"
+#include "search.hpp"
+
+class EndgameTest : public ::testing::Test {
+   protected:
+    static void SetUpTestSuite() { Bitbases::init(); }
+};
+
+TEST_F(EndgameTest, KXK) {
+    int center = Endgame::KXK(Board("8/8/8/3k4/8/3K4/8/R7 w - - 0 1"), WHITE, WHITE);
+    int edge = Endgame::KXK(Board("3k4/8/3K4/8/8/8/8/R7 w - - 0 1"), WHITE, WHITE);
+    EXPECT_GT(center, Endgame::KNOWN_WIN);
+    EXPECT_GT(edge, center) << "lone king on the edge is closer to mate";
+
+    int black = Endgame::KXK(Board("r7/8/8/8/8/3k4/8/3K4 w - - 0 1"), BLACK, WHITE);
+    EXPECT_EQ(black, -edge) << "mirrored position scores the same for black";
+
+    int knights = Endgame::KXK(Board("4k3/8/8/8/8/8/8/1N1NK3 w - - 0 1"), WHITE, WHITE);
+    EXPECT_EQ(knights, 0) << "two knights can't force mate";
+
+    int sameBishops = Endgame::KXK(Board("4k3/8/8/8/8/8/8/1B1BK3 w - - 0 1"), WHITE, WHITE);
+    int bishopPair = Endgame::KXK(Board("4k3/8/8/8/8/8/8/1BB1K3 w - - 0 1"), WHITE, WHITE);
+    EXPECT_EQ(sameBishops, 0) << "bishops on one color can't mate";
+    EXPECT_GT(bishopPair, Endgame::KNOWN_WIN);
+
+    int knightsPawn = Endgame::KXK(Board("4k3/8/8/8/8/8/P7/1N1NK3 w - - 0 1"), WHITE, WHITE);
+    EXPECT_GT(knightsPawn, 0) << "the pawn can still promote";
+    EXPECT_LT(knightsPawn, Endgame::KNOWN_WIN);
+}
+
+TEST_F(EndgameTest, KBNK) {
+    // dark squared bishop mates in a1/h8
+    int right = Endgame::KBNK(Board("8/8/8/8/8/8/8/k1BNK3 w - - 0 1"), WHITE, WHITE);
+    int wrong = Endgame::KBNK(Board("k7/8/8/8/8/8/8/2BNK3 w - - 0 1"), WHITE, WHITE);
+    EXPECT_GT(right, Endgame::KNOWN_WIN);
+    EXPECT_GT(right, wrong) << "lone king in the bishop's corner is closer to mate";
+}
+
+TEST_F(EndgameTest, KPK) {
+    // pawn outside the square of the black king queens
+    EXPECT_GT(Endgame::KPK(Board("7k/8/8/P7/8/8/8/4K3 w - - 0 1"), WHITE, WHITE),
+              Endgame::KNOWN_WIN);
+    EXPECT_LT(Endgame::KPK(Board("4k3/8/8/8/p7/8/8/7K w - - 0 1"), BLACK, BLACK),
+              -Endgame::KNOWN_WIN);
+
+    // rook pawn with the defending king in the corner
+    EXPECT_EQ(Endgame::KPK(Board("k7/8/8/8/8/8/P7/K7 w - - 0 1"), WHITE, WHITE), 0);
+    EXPECT_EQ(Endgame::KPK(Board("k7/p7/8/8/8/8/8/K7 b - - 0 1"), BLACK, BLACK), 0);
+}
+
+TEST_F(EndgameTest, ChessEval) {
+    // known endgames bypass the regular eval, relative to side to move
+    Chess white("3k4/8/8/8/8/8/8/R3K3 w - - 0 1");
+    Chess black("3k4/8/8/8/8/8/8/R3K3 b - - 0 1");
+    EXPECT_GT(white.eval<false>(), Endgame::KNOWN_WIN);
+    EXPECT_EQ(black.eval<false>(), -white.eval<false>());
+}
+
+TEST_F(EndgameTest, InsufficientMaterialIsDraw) {
+    for (auto fen : {"8/8/8/4k3/8/8/8/KNN5 w - - 0 1", "8/8/8/4k3/8/8/8/KB1B4 w - - 0 1",
+                     "knn5/8/8/4K3/8/8/8/8 w - - 0 1", "kb1b4/8/8/4K3/8/8/8/8 b - - 0 1"}) {
+        EXPECT_EQ(Chess(fen).eval<false>(), DRAWSCORE) << fen;
+    }
+}
@@ -0,0 +1,75 @@
+#include "epd.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "chess.hpp"
+
+class EPDTest : public ::testing::Test {};
+
+TEST_F(EPDTest, Parse) {
+    EPD::Position pos;
+    ASSERT_TRUE(EPD::parse(
+        "r1bq1r1k/p1pnbpp1/1p2p3/6p1/3PB3/5N2/PPPQ1PPP/2KR3R w - - bm g4 Nh4; id \"arasan20.1\"; "
+        "c0 \"J. Polgar-Berkes\";",
+        pos));
+    EXPECT_EQ(pos.fen, "r1bq1r1k/p1pnbpp1/1p2p3/6p1/3PB3/5N2/PPPQ1PPP/2KR3R w - - 0 1");
+    EXPECT_EQ(pos.id, "arasan20.1");
+    EXPECT_EQ(pos.bestMoves, (std::vector<std::string>{"g4", "Nh4"}));
+    EXPECT_TRUE(pos.avoidMoves.empty());
+
+    ASSERT_TRUE(EPD::parse("4k3/8/8/8/8/8/8/4K3 b - - am Kd7; id \"x\";", pos));
+    EXPECT_EQ(pos.avoidMoves, (std::vector<std::string>{"Kd7"}));
+    EXPECT_TRUE(pos.bestMoves.empty());
+
+    EXPECT_FALSE(EPD::parse("", pos));
+    EXPECT_FALSE(EPD::parse("4k3/8/8/8/8/8/8/4K3 b", pos));
+}
+
+TEST_F(EPDTest, RunSolvesEasyPositions) {
+    std::istringstream suite(
+        "7R/8/8/8/8/1K6/8/1k6 w - - bm Rh1#; id \"mate1\";\n"
+        "R1R5/7R/1k6/7R/8/P1P5/PKP5/1RP5 w - - bm Ka1; id \"avoid stalemate\";\n"
+        "5rk1/pb2npp1/1pq4p/5p2/5B2/1B6/P2RQ1PP/2r1R2K b - - bm Qxg2+; id \"mate2\";\n"
+        "7k/8/8/8/8/8/6q1/7K b - - am Qg1; id \"avoid\";\n"
+        "\n"
+        "7R/8/8/8/8/1K6/8/1k6 w - - bm Rh2; id \"wrong\";\n");
+    auto positions = EPD::load(suite);
+    ASSERT_EQ(positions.size(), 5);
+
+    SearchLimits limits;
+    limits.depth = 3;
+    auto report = EPD::run(positions, limits, 2);
+
+    ASSERT_EQ(report.results.size(), 5);
+    for (size_t i = 0; i < 4; ++i) EXPECT_TRUE(report.results[i].solved) << positions[i].id;
+    EXPECT_FALSE(report.results[4].solved);
+    EXPECT_EQ(report.solved, 4);
+    EXPECT_GT(report.nodes, 0);
+
+    // Same answers whatever the number of threads
+    auto single = EPD::run(positions, limits, 1);
+    for (size_t i = 0; i < positions.size(); ++i) {
+        EXPECT_EQ(single.results[i].move, report.results[i].move);
+        EXPECT_EQ(single.results[i].nodes, report.results[i].nodes);
+    }
+}
+
+TEST_F(EPDTest, RunSkipsInvalidFEN) {
+    std::istringstream suite(
+        "7R/8/8/8/8/1K6/8/1k6 w - - bm Rh1#; id \"mate1\";\n"
+        "7R/8/8/8/8/1K6/8/1k6/8 w - - bm Rh1#; id \"nine ranks\";\n");
+    auto positions = EPD::load(suite);
+    ASSERT_EQ(positions.size(), 2);
+
+    SearchLimits limits;
+    limits.depth = 3;
+    auto report = EPD::run(positions, limits, 2);
+
+    EXPECT_TRUE(report.results[0].solved);
+    EXPECT_TRUE(report.results[1].skipped);
+    EXPECT_FALSE(report.results[1].solved);
+    EXPECT_EQ(report.solved, 1);
+    EXPECT_EQ(report.skipped, 1);
+}
@@ -111,3 +111,20 @@ TEST(EvalTest, OppositeBishops) {
     EXPECT_EQ(result, true) << "different color bishops have opposite bishops";
 }
        
+
+TEST(EvalTest, Psq) {
+    static_assert(Eval::psq[B_PAWN][D7] == -Eval::psq[W_PAWN][E2]);
+    static_assert(Eval::psq[NO_PIECE][E4] == SCORE_ZERO);
+
+    for (int c = BLACK; c < N_COLORS; ++c) {
+        for (int pt = PAWN; pt < N_PIECES; ++pt) {
+            for (int sq = A1; sq < N_SQUARES; ++sq) {
+                Score s = Eval::psq[Defs::makePiece(Color(c), PieceType(pt))][sq];
+                EXPECT_EQ(mgValue(s), Eval::pieceValue(MIDGAME, Color(c), PieceType(pt)) +
+                                          Eval::pieceSqBonus(MIDGAME, Color(c), PieceType(pt), Square(sq)));
+                EXPECT_EQ(egValue(s), Eval::pieceValue(ENDGAME, Color(c), PieceType(pt)) +
+                                          Eval::pieceSqBonus(ENDGAME, Color(c), PieceType(pt), Square(sq)));
+            }
+        }
+    }
+}
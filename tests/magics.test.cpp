@@ -5,10 +5,7 @@
 #include "constants.hpp"
 #include "bb.hpp"
 
-class MagicsTest : public ::testing::Test {
-   protected:
-    static void SetUpTestSuite() { Magics::init(); }
-};
+class MagicsTest : public ::testing::Test {};
 
 U64 targets(std::vector<Square> squares);
 
@@ -90,3 +87,17 @@ TEST_F(MagicsTest, RookEdgeOfBoardWithObstacles) {
     EXPECT_EQ(Magics::getRookAttacks(A1, occupancy), expectedAttacks)
         << "should be blocked on both ranks and files";
 }
+
+TEST_F(MagicsTest, BackendsAgree) {
+    EXPECT_TRUE(Magics::verify()) << "every occupancy should match the reference attacks";
+
+#ifdef USE_PEXT
+    for (int sq = A1; sq <= H8; ++sq) {
+        U64 occ = 0x9E3779B97F4A7C15ULL * (sq + 1);
+        EXPECT_EQ(Magics::getRookAttacksPext(Square(sq), occ),
+                  Magics::getRookAttacksMagic(Square(sq), occ));
+        EXPECT_EQ(Magics::getBishopAttacksPext(Square(sq), occ),
+                  Magics::getBishopAttacksMagic(Square(sq), occ));
+    }
+#endif
+}
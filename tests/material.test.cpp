@@ -0,0 +1,65 @@
+#include "material.hpp"
+
+#include <gtest/gtest.h>
+
+#include "chess.hpp"
+#include "constants.hpp"
+#include "movegen.hpp"
+
+class MaterialTest : public ::testing::Test {};
+
+TEST_F(MaterialTest, KeyMatchesPieceCounts) {
+    EXPECT_EQ(Board(EMPTYFEN).materialKey, 0ull);
+    EXPECT_EQ(Board(E2PAWN).materialKey, Board::materialKeyBit(WHITE, PAWN));
+    EXPECT_EQ(Board(E2PAWN).materialKey, Board(E4PAWN).materialKey);
+    EXPECT_NE(Board(E2PAWN).materialKey, Board("4k3/4p3/8/8/8/8/8/4K3 w - - 0 1").materialKey);
+    EXPECT_NE(Board(STARTFEN).materialKey, Board(POS3).materialKey);
+}
+
+TEST_F(MaterialTest, KeyIsIncremental) {
+    for (auto& fen : FENS) {
+        Chess chess(fen);
+        U64 key = chess.getMaterialKey();
+
+        MoveGenerator movegen(&chess);
+        movegen.generatePseudoLegalMoves();
+        for (auto& move : movegen.moves) {
+            if (!chess.isPseudoLegalMoveLegal(move)) continue;
+
+            chess.make(move);
+            EXPECT_EQ(chess.getMaterialKey(), Board(chess.toFEN()).materialKey)
+                << fen << " " << move;
+            chess.unmake();
+            EXPECT_EQ(chess.getMaterialKey(), key) << fen << " " << move;
+        }
+    }
+}
+
+TEST_F(MaterialTest, Probe) {
+    Board board(STARTFEN);
+    Material::Entry* entry = Material::table.probe(board);
+    EXPECT_EQ(entry->key, board.materialKey);
+    EXPECT_EQ(entry->phase, Eval::PHASE_LIMIT);
+    EXPECT_EQ(entry->scale[WHITE], 64);
+    EXPECT_EQ(entry->evaluator, nullptr);
+    EXPECT_EQ(Material::table.probe(board), entry) << "second probe hits the same entry";
+
+    board = Board("3bk3/4p3/8/8/8/8/4P3/3BK3 w - - 0 1");
+    entry = Material::table.probe(board);
+    EXPECT_TRUE(entry->oppositeBishops);
+    EXPECT_EQ(entry->phase, Eval::calculatePhase(2 * Eval::mgPieceValue(BISHOP)));
+}
+
+TEST_F(MaterialTest, EndgameEvaluator) {
+    auto evaluator = [](const char* fen) { return Material::table.probe(Board(fen))->evaluator; };
+
+    EXPECT_EQ(evaluator("4k3/8/8/8/8/8/8/3QK3 w - - 0 1"), Endgame::KXK);
+    EXPECT_EQ(evaluator("3qk3/8/8/8/8/8/8/4K3 w - - 0 1"), Endgame::KXK);
+    EXPECT_EQ(evaluator("4k3/8/8/8/8/8/8/2BNK3 w - - 0 1"), Endgame::KBNK);
+    EXPECT_EQ(evaluator(E2PAWN), Endgame::KPK);
+    EXPECT_EQ(evaluator(EMPTYFEN), nullptr);
+    EXPECT_EQ(evaluator("4k3/8/8/8/8/8/8/3NK3 w - - 0 1"), nullptr);
+    EXPECT_EQ(evaluator("3nk3/8/8/8/8/8/8/3QK3 w - - 0 1"), nullptr);
+
+    EXPECT_EQ(Material::table.probe(Board("3qk3/8/8/8/8/8/8/4K3 w - - 0 1"))->strongSide, BLACK);
+}
@@ -0,0 +1,83 @@
+#include "output.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <sstream>
+#include <streambuf>
+#include <thread>
+
+using namespace std::chrono;
+
+// A reader that takes DELAY to accept every flush, like a GUI busy
+// elsewhere with a full pipe
+class SlowReader : public std::stringbuf {
+   public:
+    static constexpr milliseconds DELAY{20};
+    int flushes = 0;
+
+   protected:
+    int sync() override {
+        std::this_thread::sleep_for(DELAY);
+        ++flushes;
+        return 0;
+    }
+};
+
+TEST(OutputTest, WritesInOrder) {
+    std::ostringstream os;
+    Output output(os);
+    for (int i = 0; i < 100; ++i) output.write("line " + std::to_string(i) + "\n");
+    output.flush();
+
+    std::string expected;
+    for (int i = 0; i < 100; ++i) expected += "line " + std::to_string(i) + "\n";
+    EXPECT_EQ(os.str(), expected);
+}
+
+TEST(OutputTest, SlowReaderDoesNotBlockWriter) {
+    const int LINES = 50;
+    std::string line = "info depth 10 score cp 25 nodes 123456 nps 1000000 time 123\n";
+
+    // Writing straight to the stream waits for the reader on every line
+    SlowReader direct;
+    std::ostream os(&direct);
+    auto begin = steady_clock::now();
+    for (int i = 0; i < LINES; ++i) os << line << std::flush;
+    auto directTime = steady_clock::now() - begin;
+
+    // Through Output the writer only appends, and the reader gets the lines
+    // in a few batches
+    SlowReader buffered;
+    std::ostream bos(&buffered);
+    {
+        Output output(bos);
+        begin = steady_clock::now();
+        for (int i = 0; i < LINES; ++i) output.post(line);
+        auto bufferedTime = steady_clock::now() - begin;
+
+        RecordProperty("direct_us", duration_cast<microseconds>(directTime).count());
+        RecordProperty("buffered_us", duration_cast<microseconds>(bufferedTime).count());
+        EXPECT_GE(directTime, LINES * SlowReader::DELAY);
+        EXPECT_LT(bufferedTime, LINES * SlowReader::DELAY / 10);
+    }
+
+    EXPECT_EQ(buffered.str().size(), LINES * line.size());
+    EXPECT_LT(buffered.flushes, LINES);
+}
+
+TEST(OutputTest, PostDropsBehindStalledReader) {
+    SlowReader reader;
+    std::ostream os(&reader);
+    Output output(os);
+
+    // Posts stop being accepted once the backlog is full, writes never are
+    std::string chunk(1024, 'x');
+    int posted = 0;
+    while (output.post(chunk)) ++posted;
+    EXPECT_LE(posted * chunk.size(), 2 * Output::MAX_BACKLOG);
+
+    output.write("bestmove e2e4\n");
+    output.flush();
+    EXPECT_EQ(reader.str().substr(reader.str().size() - 14), "bestmove e2e4\n");
+}
@@ -0,0 +1,50 @@
+#include "perf.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <thread>
+
+TEST(PerfTest, WallClockAlwaysCounts) {
+    Perf::Counters counters;
+    counters.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    Perf::Sample sample = counters.stop();
+
+    EXPECT_GE(sample.seconds, 0.005);
+    if (!Perf::ENABLED) {
+        EXPECT_FALSE(sample.any());
+    }
+}
+
+TEST(PerfTest, CountsWhenAvailable) {
+    Perf::Counters counters;
+    counters.start();
+    volatile U64 sum = 0;
+    for (int i = 0; i < 100000; ++i) sum = sum + i;
+    Perf::Sample sample = counters.stop();
+
+    if (sample.counted[Perf::INSTRUCTIONS]) {
+        EXPECT_GT(sample.counts[Perf::INSTRUCTIONS], 100000);
+    }
+}
+
+TEST(PerfTest, Print) {
+    Perf::Sample sample;
+    sample.seconds = 1.5;
+
+    // Missing counters leave only the time
+    std::ostringstream os;
+    Perf::print(os, sample, 1000);
+    EXPECT_EQ(os.str(), " time 1500");
+
+    sample.counts[Perf::CYCLES] = 4000;
+    sample.counts[Perf::INSTRUCTIONS] = 10000;
+    sample.counts[Perf::BRANCH_MISSES] = 250;
+    sample.counted[Perf::CYCLES] = sample.counted[Perf::INSTRUCTIONS] = true;
+    sample.counted[Perf::BRANCH_MISSES] = true;
+
+    os.str("");
+    Perf::print(os, sample, 1000);
+    EXPECT_EQ(os.str(), " time 1500 ipc 2.50 cycles/node 4.00 branch-misses/node 0.25");
+}
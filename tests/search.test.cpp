@@ -6,17 +6,12 @@
 
 #include "chess.hpp"
 #include "constants.hpp"
+#include "movegen.hpp"
 
 // Perft positions and results
 // https://www.chessprogramming.org/Perft_Results
 
-class PerftTest : public ::testing::TestWithParam<std::tuple<std::string, std::vector<long>>> {
-   protected:
-    void SetUp() override {
-        Magics::init();
-        Zobrist::init();
-    }
-};
+class PerftTest : public ::testing::TestWithParam<std::tuple<std::string, std::vector<long>>> {};
 
 TEST_P(PerftTest, PerftForMultipleDepths) {
     auto [fen, expected_results] = GetParam();
@@ -69,6 +64,132 @@ INSTANTIATE_TEST_SUITE_P(Position5PerftTestSuite,
                                                                //    89941194
                                                            })));
 
+// Search results for positions with a known answer
+
+struct SearchPosition {
+    std::string fen;
+    Move bestMove;
+    int depth;
+    int score;
+};
+
+class SearchTest : public ::testing::TestWithParam<SearchPosition> {};
+
+TEST_P(SearchTest, FindsBestMove) {
+    auto pos = GetParam();
+    Chess chess(pos.fen);
+    Search search(&chess);
+    search.think(pos.depth);
+
+    EXPECT_EQ(search.bestMove, pos.bestMove);
+    EXPECT_EQ(search.bestScore, pos.score);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Integration,
+    SearchTest,
+    ::testing::Values(
+        // Mate in 1
+        SearchPosition{"7R/8/8/8/8/1K6/8/1k6 w - - 0 1", Move(H8, H1), 1, 32000 - 1},
+        // Mate in 2
+        SearchPosition{"5rk1/pb2npp1/1pq4p/5p2/5B2/1B6/P2RQ1PP/2r1R2K b - - 0 1", Move(C6, G2), 3,
+                       32000 - 3},
+        // Mate in 1 avoiding stalemate
+        SearchPosition{"R1R5/7R/1k6/7R/8/P1P5/PKP5/1RP5 w - - 0 1", Move(B2, A1), 1, 32000 - 1}));
+
+TEST(SearchDrawTest, Stalemate) {
+    Chess chess("R1R5/7R/1k6/7R/8/8/8/1K6 b - - 0 1");
+    Search search(&chess);
+    search.think(1);
+    EXPECT_TRUE(search.bestMove.isNullMove());
+}
+
+TEST(SearchDrawTest, PerpetualCheck) {
+    // Worse off against two rooks, but Qd8+ and Qg5+ check forever
+    Chess chess("6k1/5p1p/8/6Q1/8/8/rr6/7K w - - 0 1");
+    Search search(&chess);
+    search.think(6);
+    EXPECT_EQ(search.bestMove, Move(G5, D8));
+    EXPECT_EQ(search.bestScore, DRAWSCORE);
+}
+
+TEST(SearchLimitsTest, NodeLimit) {
+    Chess chess(POS2);
+    Search search(&chess);
+    search.silent = true;
+
+    SearchLimits limits;
+    limits.nodes = 5000;
+    search.think(limits);
+    EXPECT_FALSE(search.bestMove.isNullMove());
+    EXPECT_GE(search.getNodes(), 5000);
+    EXPECT_LT(search.getNodes(), 5100);
+}
+
+TEST(SearchLimitsTest, MoveTime) {
+    Chess chess(POS2);
+    Search search(&chess);
+    search.silent = true;
+
+    SearchLimits limits;
+    limits.movetime = 50;
+    auto start = std::chrono::steady_clock::now();
+    search.think(limits);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+    EXPECT_FALSE(search.bestMove.isNullMove());
+    EXPECT_LT(ms, 500);
+}
+
+TEST(SearchTableTest, TablePerSearch) {
+    Chess chess(POS2);
+    Search search(&chess, 1);
+    Search other(&chess, 1);
+    search.silent = true;
+
+    search.think(3);
+    EXPECT_NE(search.tt.probe(chess.getKey()), nullptr);
+    EXPECT_EQ(other.tt.probe(chess.getKey()), nullptr);
+
+    // Resizing starts over with an empty table
+    search.tt.resize(2);
+    EXPECT_EQ(search.tt.probe(chess.getKey()), nullptr);
+}
+
+TEST(SearchTableTest, HistoryCarriesOver) {
+    Chess chess(POS2);
+    Search search(&chess);
+    search.silent = true;
+
+    // History shows in the order scores of the quiet moves
+    auto history = [&] {
+        auto movegen = MoveGenerator(&chess);
+        movegen.generatePseudoLegalMoves();
+        search.sortMoves(movegen.moves);
+
+        I64 total = 0;
+        for (auto& move : movegen.moves)
+            if (move != search.bestMove && chess.getPiece(move.to()) == NO_PIECE &&
+                move.type() != PROMOTION)
+                total += move.score;
+        return total;
+    };
+
+    search.think(5);
+    I64 learned = history();
+    EXPECT_GT(learned, 0);
+
+    // The next search starts from half of it rather than from nothing, a
+    // depth 1 search adds none for the side to move
+    search.think(1);
+    EXPECT_GT(history(), 0);
+    EXPECT_LT(history(), learned);
+
+    search.newGame();
+    EXPECT_EQ(history(), 0);
+}
+
 // prev search tests
 
 // enum ScoreType {
@@ -0,0 +1,62 @@
+#include "stats.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <type_traits>
+
+#include "chess.hpp"
+#include "constants.hpp"
+#include "search.hpp"
+
+TEST(StatsTest, DisabledIsEmpty) {
+    EXPECT_TRUE(std::is_empty_v<SearchStats<false>>);
+
+    SearchStats<false> stats;
+    stats.add(TT_HITS);
+    EXPECT_EQ(stats.get(TT_HITS), 0);
+}
+
+TEST(StatsTest, Counts) {
+    SearchStats<true> stats;
+    stats.add(TT_PROBES);
+    stats.add(TT_PROBES);
+    stats.add(TT_HITS);
+    stats.qsearchDepth(1);
+    stats.qsearchDepth(100);
+    EXPECT_EQ(stats.get(TT_PROBES), 2);
+    EXPECT_EQ(stats.get(TT_HITS), 1);
+    EXPECT_EQ(stats.getQsearchDepth(1), 1);
+    EXPECT_EQ(stats.getQsearchDepth(SearchStats<true>::QSEARCH_DEPTHS - 1), 1);
+
+    std::ostringstream os;
+    os << stats;
+    EXPECT_NE(os.str().find("tt probes 2 hits 1 (50.0%)"), std::string::npos);
+    EXPECT_NE(os.str().find("qsearch depth 1:1 15:1"), std::string::npos);
+
+    stats.clear();
+    EXPECT_EQ(stats.get(TT_PROBES), 0);
+}
+
+TEST(StatsTest, CollectedBySearch) {
+    Chess chess(POS2);
+    Search search(&chess);
+    search.silent = true;
+    search.think(4);
+
+    if (!STATS_ENABLED) return;
+
+    // Sub-counts never exceed what they are part of
+    auto& stats = search.stats;
+    EXPECT_GT(stats.get(PV_NODES), 0);
+    EXPECT_GT(stats.get(QSEARCH_NODES), 0);
+    EXPECT_LE(stats.get(TT_HITS), stats.get(TT_PROBES));
+    EXPECT_LE(stats.get(FIRST_MOVE_CUTOFFS), stats.get(CUT_NODES));
+    EXPECT_LE(stats.get(LMR_RESEARCHES), stats.get(LMR_REDUCTIONS));
+    EXPECT_EQ(stats.get(QSEARCH_NODES), [&] {
+        U64 total = 0;
+        for (int d = 0; d < SearchStats<true>::QSEARCH_DEPTHS; ++d)
+            total += stats.getQsearchDepth(d);
+        return total;
+    }());
+}
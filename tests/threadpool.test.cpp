@@ -0,0 +1,25 @@
+#include "threadpool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+TEST(ThreadPoolTest, Submit) {
+    ThreadPool pool(3);
+    std::atomic<int> count = 0;
+    for (int i = 0; i < 100; ++i) pool.submit([&count] { ++count; });
+    pool.wait();
+    EXPECT_EQ(count, 100);
+}
+
+TEST(ThreadPoolTest, ParallelFor) {
+    ThreadPool pool(4);
+    std::vector<long> partial(pool.size());
+    pool.parallelFor(1000, [&](size_t worker, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) partial[worker] += i;
+    });
+
+    long total = 0;
+    for (long sum : partial) total += sum;
+    EXPECT_EQ(total, 999 * 1000 / 2);
+}
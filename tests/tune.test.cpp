@@ -0,0 +1,104 @@
+#include "tune.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <sstream>
+
+#include "chess.hpp"
+#include "constants.hpp"
+
+class TuneTest : public ::testing::Test {};
+
+TEST_F(TuneTest, ParseResult) {
+    float result = -1;
+    EXPECT_TRUE(Tune::parseResult(std::string(STARTFEN) + " c9 \"1-0\";", result));
+    EXPECT_EQ(result, 1.0f);
+    EXPECT_TRUE(Tune::parseResult(std::string(STARTFEN) + " c9 \"1/2-1/2\";", result));
+    EXPECT_EQ(result, 0.5f);
+    EXPECT_TRUE(Tune::parseResult(std::string(STARTFEN) + " [0.0]", result));
+    EXPECT_EQ(result, 0.0f);
+    EXPECT_FALSE(Tune::parseResult(STARTFEN, result));
+}
+
+TEST_F(TuneTest, ConvertSkipsBadLines) {
+    std::istringstream is(std::string(STARTFEN) + " [1.0]\n" +
+                          "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNX w KQkq - [1.0]\n" +
+                          "rnbqkbnr/pppppppp/9/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - [0.5]\n" +
+                          STARTFEN + "\n");
+    Tune::Dataset data;
+    EXPECT_EQ(data.convert(is), 3);
+    EXPECT_EQ(data.size(), 1);
+}
+
+TEST_F(TuneTest, LinearEvalMatchesEval) {
+    Tune::Params params = Tune::initialParams();
+    for (auto fen : {STARTFEN, POS2, POS4W, POS4B, POS5}) {
+        Chess c(fen);
+        Tune::Dataset data;
+        ASSERT_TRUE(data.add(fen, 0.5f));
+
+        double linear = Tune::linearEval(data, data.entries[0], params);
+        int score = c.eval<false>();
+        if (data.entries[0].tempo < 0) score = -score;
+        EXPECT_NEAR(linear, score, 1.0) << fen;
+    }
+}
+
+TEST_F(TuneTest, SaveLoad) {
+    Tune::Dataset data;
+    data.add(STARTFEN, 1.0f);
+    data.add(POS2, 0.5f);
+    data.add(POS3, 0.0f);
+    data.add(POS4W, 0.73f);  // a bracketed score, kept exactly
+
+    std::string path = (std::filesystem::temp_directory_path() / "latrunculi_tune.bin").string();
+    ASSERT_TRUE(data.save(path));
+
+    Tune::Dataset loaded;
+    ASSERT_TRUE(loaded.load(path));
+    std::remove(path.c_str());
+
+    ASSERT_EQ(loaded.size(), data.size());
+    ASSERT_EQ(loaded.features.size(), data.features.size());
+    Tune::Params params = Tune::initialParams();
+    for (size_t i = 0; i < data.size(); ++i) {
+        EXPECT_EQ(loaded.entries[i].result, data.entries[i].result);
+        EXPECT_EQ(Tune::linearEval(loaded, loaded.entries[i], params),
+                  Tune::linearEval(data, data.entries[i], params));
+    }
+}
+
+TEST_F(TuneTest, AdamReducesLoss) {
+    Tune::Dataset data;
+    data.add(STARTFEN, 0.5f);
+    data.add(POS2, 1.0f);
+    data.add(POS3, 0.0f);
+    data.add(POS4W, 1.0f);
+    data.add(POS5, 0.0f);
+
+    ThreadPool pool(2);
+    Tune::Params params = Tune::initialParams();
+    double k = 0.005;
+    double before = Tune::loss(data, params, k, pool);
+
+    Tune::Adam adam(1.0);
+    Tune::Params grad;
+    for (int i = 0; i < 20; ++i) {
+        Tune::gradient(data, params, k, pool, grad);
+        adam.step(params, grad);
+    }
+    EXPECT_LT(Tune::loss(data, params, k, pool), before);
+}
+
+TEST_F(TuneTest, WriteHeader) {
+    std::ostringstream os;
+    Tune::writeHeader(os, Tune::initialParams());
+    std::string header = os.str();
+
+    EXPECT_NE(header.find("const Score ISO_PAWN_PENALTY = makeScore(-5, -15);"), std::string::npos);
+    EXPECT_NE(header.find("{0, 124, 781, 825, 1276, 2538, 0}"), std::string::npos);
+    EXPECT_NE(header.find("constexpr ScoreArray kingBonusEg = {{"), std::string::npos);
+}
@@ -31,3 +31,21 @@ TEST(TypesTest, CastleRights) {
     EXPECT_EQ(ALL_CASTLE ^ BLACK_OOO, WHITE_CASTLE | BLACK_OO);
     EXPECT_EQ(ALL_CASTLE ^ BLACK_OO, WHITE_CASTLE | BLACK_OOO);
 }
+
+TEST(TypesTest, Score) {
+    for (int mg : {-300, -1, 0, 1, 250}) {
+        for (int eg : {-300, -1, 0, 1, 250}) {
+            Score s = makeScore(mg, eg);
+            EXPECT_EQ(mgValue(s), mg);
+            EXPECT_EQ(egValue(s), eg);
+        }
+    }
+
+    Score s = makeScore(10, -20) + makeScore(-30, 5);
+    EXPECT_EQ(mgValue(s), -20);
+    EXPECT_EQ(egValue(s), -15);
+    s = makeScore(3, -4) * -3;
+    EXPECT_EQ(mgValue(s), -9);
+    EXPECT_EQ(egValue(s), 12);
+    EXPECT_EQ(-makeScore(7, -8), makeScore(-7, 8));
+}
@@ -0,0 +1,183 @@
+#include "uci.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+#include "constants.hpp"
+
+class UCITest : public ::testing::Test {
+   protected:
+    std::istringstream input;
+    std::ostringstream output;
+    UCI::Controller controller{input, output};
+
+    std::string fen() {
+        // The last line printed by "d" is the FEN
+        output.str("");
+        controller.execute("d");
+        std::string text = output.str();
+        while (!text.empty() && text.back() == '\n') text.pop_back();
+        return text.substr(text.rfind('\n') + 1);
+    }
+
+    static std::string fenAfter(const std::string& start, const std::string& moves) {
+        std::istringstream is;
+        std::ostringstream os;
+        UCI::Controller fresh(is, os);
+        fresh.execute("position fen " + start + " moves " + moves);
+        fresh.execute("d");
+        std::string text = os.str();
+        while (!text.empty() && text.back() == '\n') text.pop_back();
+        return text.substr(text.rfind('\n') + 1);
+    }
+};
+
+TEST_F(UCITest, PositionMoves) {
+    controller.execute("position startpos moves e2e4 e7e5 g1f3");
+    EXPECT_EQ(fen(), "rnbqkbnr/pppp1ppp/8/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R b KQkq - 1 2");
+
+    controller.execute("position fen " + std::string(POS2) + " moves e1g1 a6e2");
+    EXPECT_EQ(fen(), Chess("r3k2r/p1ppqpb1/1n2pnp1/3PN3/1p2P3/2N2Q1p/PPPBbPPP/R4RK1 w kq - 0 2")
+                         .toFEN());
+
+    controller.execute("position startpos");
+    EXPECT_EQ(fen(), Chess(STARTFEN).toFEN());
+}
+
+TEST_F(UCITest, PositionExtendsCurrentGame) {
+    std::string game = "position startpos moves";
+    for (auto move : {"e2e4", "c7c5", "g1f3", "d7d6", "d2d4", "c5d4", "f3d4", "g8f6"}) {
+        game += std::string(" ") + move;
+        controller.execute(game);
+    }
+    EXPECT_EQ(fen(), fenAfter(STARTFEN, "e2e4 c7c5 g1f3 d7d6 d2d4 c5d4 f3d4 g8f6"));
+
+    // A different continuation takes back only the moves that differ
+    controller.execute("position startpos moves e2e4 c7c5 g1f3 b8c6 d2d4");
+    EXPECT_EQ(fen(), fenAfter(STARTFEN, "e2e4 c7c5 g1f3 b8c6 d2d4"));
+
+    controller.execute("position startpos moves e2e4");
+    EXPECT_EQ(fen(), fenAfter(STARTFEN, "e2e4"));
+}
+
+TEST_F(UCITest, MoveCommandKeepsPositionInSync) {
+    controller.execute("position startpos moves e2e4");
+    controller.execute("move e7e5");
+    controller.execute("position startpos moves e2e4 e7e5 g1f3");
+    EXPECT_EQ(fen(), fenAfter(STARTFEN, "e2e4 e7e5 g1f3"));
+
+    controller.execute("move undo");
+    controller.execute("move undo");
+    controller.execute("position startpos moves e2e4 c7c5");
+    EXPECT_EQ(fen(), fenAfter(STARTFEN, "e2e4 c7c5"));
+}
+
+TEST_F(UCITest, PositionStopsAtIllegalMove) {
+    controller.execute("position startpos moves e2e4 e2e4 e7e5");
+    EXPECT_EQ(fen(), fenAfter(STARTFEN, "e2e4"));
+
+    controller.execute("position startpos moves e2e4 e7e5");
+    EXPECT_EQ(fen(), fenAfter(STARTFEN, "e2e4 e7e5"));
+}
+
+TEST_F(UCITest, GoWritesToOutput) {
+    // The search reports through the controller's stream, drained by the
+    // time it has finished
+    controller.execute("position startpos");
+    output.str("");
+    controller.execute("go depth 3");
+    controller.wait();
+
+    std::string text = output.str();
+    EXPECT_EQ(text.find("info depth"), 0u);
+    EXPECT_NE(text.find("info depth 3"), std::string::npos);
+    EXPECT_EQ(text.rfind("bestmove "), text.rfind('\n', text.size() - 2) + 1);
+}
+
+TEST_F(UCITest, HashOption) {
+    controller.execute("uci");
+    EXPECT_NE(output.str().find("option name Hash type spin default 16 min 1 max 65536"),
+              std::string::npos);
+
+    controller.execute("setoption name Hash value 1");
+    controller.execute("go depth 2");
+    output.str("");
+    controller.execute("tt");
+    EXPECT_NE(output.str().find("Best"), std::string::npos);
+
+    // A new game starts from an empty table
+    controller.execute("ucinewgame");
+    output.str("");
+    controller.execute("tt");
+    EXPECT_EQ(output.str(), "");
+}
+
+TEST_F(UCITest, InfiniteSearchWaitsForStop) {
+    controller.execute("position startpos");
+    output.str("");
+
+    // Done with depth 1 straight away, but the move is held back
+    controller.execute("go infinite depth 1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    controller.execute("isready");
+    EXPECT_NE(output.str().find("readyok"), std::string::npos);
+    EXPECT_EQ(output.str().find("bestmove"), std::string::npos);
+
+    controller.execute("stop");
+    EXPECT_NE(output.str().find("bestmove"), std::string::npos);
+}
+
+TEST_F(UCITest, StopEndsSearch) {
+    controller.execute("position startpos");
+    output.str("");
+
+    auto start = std::chrono::steady_clock::now();
+    controller.execute("go");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    controller.execute("stop");
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+
+    std::string text = output.str();
+    EXPECT_EQ(text.rfind("bestmove "), text.rfind('\n', text.size() - 2) + 1);
+    EXPECT_FALSE(controller.execute("quit"));
+}
+
+TEST_F(UCITest, PonderClockStartsOnPonderhit) {
+    controller.execute("position startpos");
+    controller.execute("go ponder movetime 50");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // The whole movetime is left once the opponent plays the expected move
+    auto ponderhit = std::chrono::steady_clock::now();
+    controller.execute("ponderhit");
+    controller.wait();
+    EXPECT_GE(std::chrono::steady_clock::now() - ponderhit, std::chrono::milliseconds(40));
+    EXPECT_NE(output.str().find("bestmove"), std::string::npos);
+}
+
+TEST(UCITokenizerTest, Words) {
+    UCI::Tokenizer tokens("  go\tdepth  5\r\n");
+    EXPECT_EQ(tokens.next(), "go");
+    EXPECT_EQ(tokens.next(), "depth");
+    EXPECT_EQ(tokens.next(), "5");
+    EXPECT_EQ(tokens.next(), "");
+    EXPECT_EQ(tokens.next(), "");
+}
+
+TEST_F(UCITest, ParsesCastlingAndPromotion) {
+    controller.execute("position fen 4k3/P7/8/8/8/8/8/R3K3 w Q - 0 1 moves e1c1 e8f7 a7a8n");
+    EXPECT_EQ(fen(), Chess("N7/5k2/8/8/8/8/8/2KR4 b - - 0 2").toFEN());
+
+    // A promotion needs its piece
+    controller.execute("position fen 4k3/P7/8/8/8/8/8/R3K3 w Q - 0 1 moves a7a8");
+    EXPECT_EQ(fen(), Chess("4k3/P7/8/8/8/8/8/R3K3 w Q - 0 1").toFEN());
+}
+
+TEST_F(UCITest, ToleratesBlankAndPaddedLines) {
+    EXPECT_TRUE(controller.execute(""));
+    controller.execute(" position  startpos moves e2e4  e7e5\r");
+    EXPECT_EQ(fen(), fenAfter(STARTFEN, "e2e4 e7e5"));
+}
@@ -0,0 +1,32 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "book.hpp"
+
+// Build a Polyglot opening book from PGN games
+//
+//   book <games.pgn> <book.bin> [plies]
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: book <games.pgn> <book.bin> [plies]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream is(argv[1]);
+    if (!is) {
+        std::cerr << "cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    int plies = argc > 3 ? std::stoi(argv[3]) : 20;
+    auto entries = Book::fromPGN(is, plies);
+    if (!Book::write(argv[2], entries)) {
+        std::cerr << "cannot write " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::cout << "entries " << entries.size() << std::endl;
+    return 0;
+}
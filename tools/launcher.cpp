@@ -0,0 +1,45 @@
+#include <unistd.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+// Runs the release build for the highest x86-64 level the CPU supports,
+// from the directory the launcher is in, passing the arguments through
+//
+//   release/Latrunculi [args]
+//
+// LATRUNCULI_LEVEL=x86-64-v2 picks a level by hand, e.g. to compare them.
+
+int main(int argc, char* argv[]) {
+    struct Level {
+        const char* name;
+        bool supported;
+    };
+    const Level levels[] = {
+        {"x86-64-v4", bool(__builtin_cpu_supports("x86-64-v4"))},
+        {"x86-64-v3", bool(__builtin_cpu_supports("x86-64-v3"))},
+        {"x86-64-v2", bool(__builtin_cpu_supports("x86-64-v2"))},
+    };
+
+    std::error_code ec;
+    auto dir = std::filesystem::read_symlink("/proc/self/exe", ec).parent_path();
+    if (ec) dir = std::filesystem::path(argv[0]).parent_path();
+
+    const char* forced = std::getenv("LATRUNCULI_LEVEL");
+    for (auto& level : levels) {
+        if (forced ? std::string(forced) != level.name : !level.supported) continue;
+
+        std::string path = (dir / ("Latrunculi-" + std::string(level.name))).string();
+        if (access(path.c_str(), X_OK) != 0) continue;
+
+        argv[0] = path.data();
+        execv(path.c_str(), argv);
+        std::cerr << "cannot run " << path << std::endl;
+        return 1;
+    }
+
+    std::cerr << "no release build for this CPU in " << dir << std::endl;
+    return 1;
+}
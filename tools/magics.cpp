@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "magics.hpp"
+
+// Search for black magics whose rook and bishop tables pack into one shared
+// array, overlapping wherever entries are unused or agree, and write them
+// out as the header the engine's attack tables are generated from
+//
+//   magics <magicnums.hpp> [candidates] [seed]
+//
+// Black magics index with (occupied | ~mask) * magic >> shift. Unlike plain
+// fancy magics, which at full width are always a perfect hash, they often
+// leave slots unused that other tables can be packed into.
+// http://www.talkchess.com/forum/viewtopic.php?t=64790
+
+namespace {
+
+// A slider always attacks at least one square, so zero marks a free slot
+constexpr U64 FREE = 0;
+
+struct Slider {
+    bool rook = false;
+    int sq = 0;
+    U64 mask = 0;
+    int bits = 0;
+    std::vector<U64> occupancies = {};
+    std::vector<U64> attacks = {};
+
+    // Scratch table of the magic being tried, valid where stamped this try
+    std::vector<U64> scratch = {};
+    std::vector<U32> stamps = {};
+    U32 stamp = 0;
+};
+
+struct Candidate {
+    U64 magic = 0;
+    int shift = 0;
+    std::vector<U64> table;
+    std::vector<int> used;
+};
+
+struct Placement {
+    U64 magic;
+    int shift;
+    int offset;
+};
+
+Slider makeSlider(bool rook, int sq) {
+    U64 mask = rook ? Magics::rookMagicMask[sq] : Magics::bishopMagicMask[sq];
+    Slider slider{.rook = rook, .sq = sq, .mask = mask, .bits = std::popcount(mask)};
+
+    U64 occupied = 0;
+    do {
+        slider.occupancies.push_back(occupied | ~slider.mask);
+        slider.attacks.push_back(rook ? Magics::initMagicRook(sq, occupied)
+                                      : Magics::initMagicBishop(sq, occupied));
+        occupied = (occupied - slider.mask) & slider.mask;
+    } while (occupied);
+    return slider;
+}
+
+// Fill the table a magic indexes into, failing on a destructive collision
+bool tryMagic(Slider& slider, U64 magic, int bits, Candidate& candidate) {
+    size_t size = size_t(1) << bits;
+    int shift = 64 - bits;
+    if (slider.scratch.size() < size) {
+        slider.scratch.resize(size);
+        slider.stamps.resize(size);
+    }
+    ++slider.stamp;
+
+    for (size_t i = 0; i < slider.occupancies.size(); ++i) {
+        size_t index = (slider.occupancies[i] * magic) >> shift;
+        U64& entry = slider.scratch[index];
+        if (slider.stamps[index] == slider.stamp) {
+            if (entry != slider.attacks[i]) return false;
+        } else {
+            slider.stamps[index] = slider.stamp;
+            entry = slider.attacks[i];
+        }
+    }
+
+    candidate.magic = magic;
+    candidate.shift = shift;
+    candidate.table.assign(size, FREE);
+    candidate.used.clear();
+    for (size_t j = 0; j < size; ++j) {
+        if (slider.stamps[j] != slider.stamp) continue;
+        candidate.table[j] = slider.scratch[j];
+        candidate.used.push_back(j);
+    }
+    return true;
+}
+
+// Several working magics for the slider, preferring one bit fewer than the
+// mask if any turn up within the try budget
+std::vector<Candidate> findCandidates(Slider& slider, int count, std::mt19937_64& rng) {
+    std::vector<Candidate> found;
+    Candidate candidate;
+
+    for (int bits : {slider.bits - 1, slider.bits}) {
+        long budget = bits < slider.bits ? 200000 : 100000000;
+        for (long tries = 0; tries < budget && int(found.size()) < count; ++tries) {
+            U64 magic = rng() & rng() & rng();
+            if (tryMagic(slider, magic, bits, candidate)) found.push_back(candidate);
+        }
+        if (!found.empty()) break;
+    }
+    return found;
+}
+
+// Lowest offset at which every used slot lands on a free or equal entry
+int lowestFit(const std::vector<U64>& db, const Candidate& candidate) {
+    int first = candidate.used.front();
+    for (int offset = -first;; ++offset) {
+        bool fits = true;
+        for (int j : candidate.used) {
+            size_t k = size_t(offset + j);
+            if (k < db.size() && db[k] != FREE && db[k] != candidate.table[j]) {
+                fits = false;
+                break;
+            }
+        }
+        if (fits) return offset;
+    }
+}
+
+void writeArray(std::ostream& os, const char* type, const char* name, const Placement* p,
+                int field) {
+    os << "constexpr " << type << " " << name << "[64] = {";
+    for (int sq = 0; sq < 64; ++sq) {
+        os << (sq % 4 == 0 ? "\n    " : " ");
+        if (field == 0)
+            os << "0x" << std::hex << std::setw(16) << std::setfill('0') << p[sq].magic
+               << std::dec << "ull";
+        else
+            os << (field == 1 ? p[sq].shift : p[sq].offset);
+        if (sq < 63) os << ",";
+    }
+    os << "};\n\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: magics <magicnums.hpp> [candidates] [seed]" << std::endl;
+        return 1;
+    }
+
+    int count = argc > 2 ? std::stoi(argv[2]) : 16;
+    U64 seed = argc > 3 ? std::stoull(argv[3]) : 1;
+    std::mt19937_64 rng(seed);
+
+    std::vector<Slider> sliders;
+    for (bool rook : {true, false}) {
+        for (int sq = 0; sq < 64; ++sq) sliders.push_back(makeSlider(rook, sq));
+    }
+
+    // The biggest tables go in first, the small ones fill their holes
+    std::stable_sort(sliders.begin(), sliders.end(),
+                     [](const Slider& a, const Slider& b) { return a.bits > b.bits; });
+
+    std::vector<U64> db;
+    Placement rooks[64], bishops[64];
+    int saved = 0;
+
+    for (auto& slider : sliders) {
+        auto candidates = findCandidates(slider, count, rng);
+        if (candidates.empty()) {
+            std::cerr << "no magic found for square " << slider.sq << std::endl;
+            return 1;
+        }
+
+        // Place whichever candidate grows the shared table least
+        const Candidate* best = nullptr;
+        int bestOffset = 0;
+        size_t bestEnd = SIZE_MAX;
+        for (auto& candidate : candidates) {
+            int offset = lowestFit(db, candidate);
+            size_t end = std::max(db.size(), size_t(offset + candidate.used.back() + 1));
+            // On a tie keep the sparser table, leaving more holes to fill
+            if (end < bestEnd || (end == bestEnd && candidate.used.size() < best->used.size())) {
+                best = &candidate;
+                bestOffset = offset;
+                bestEnd = end;
+            }
+        }
+
+        db.resize(bestEnd, FREE);
+        for (int j : best->used) db[bestOffset + j] = best->table[j];
+        (slider.rook ? rooks : bishops)[slider.sq] = {best->magic, best->shift, bestOffset};
+        saved += 64 - best->shift < slider.bits;
+    }
+
+    std::ofstream os(argv[1]);
+    if (!os) {
+        std::cerr << "cannot write " << argv[1] << std::endl;
+        return 1;
+    }
+
+    os << "#ifndef LATRUNCULI_MAGICNUMS_H\n#define LATRUNCULI_MAGICNUMS_H\n\n";
+    os << "#include \"types.hpp\"\n\n";
+    os << "// Generated by tools/magics.cpp (seed " << seed << ", " << count
+       << " candidates per square)\n";
+    os << "// Rook and bishop attacks share one overlapping table of " << db.size()
+       << " entries\n";
+    os << "namespace Magics {\n\n";
+    os << "constexpr int SLIDER_TABLE_SIZE = " << db.size() << ";\n\n";
+    writeArray(os, "U64", "rookMagicNum", rooks, 0);
+    writeArray(os, "int", "rookMagicShift", rooks, 1);
+    writeArray(os, "int", "rookOffset", rooks, 2);
+    writeArray(os, "U64", "bishopMagicNum", bishops, 0);
+    writeArray(os, "int", "bishopMagicShift", bishops, 1);
+    writeArray(os, "int", "bishopOffset", bishops, 2);
+    os << "}  // namespace Magics\n\n#endif\n";
+
+    std::cout << "table " << db.size() << " entries (" << db.size() * sizeof(U64) / 1024
+              << " KB), " << saved << " squares with a bit to spare, was "
+              << 102400 + 5248 << " entries (" << (102400 + 5248) * sizeof(U64) / 1024
+              << " KB)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,334 @@
+#include <benchmark/benchmark.h>
+
+#include <sstream>
+#include <vector>
+
+#include "batch.hpp"
+#include "bb.hpp"
+#include "bench.hpp"
+#include "board.hpp"
+#include "chess.hpp"
+#include "constants.hpp"
+#include "magics.hpp"
+#include "movegen.hpp"
+#include "tt.hpp"
+#include "uci.hpp"
+
+// Micro-benchmarks of the core primitives
+//
+//   latrunculi_bench --benchmark_format=json > before.json
+//
+// Google Benchmark's tools/compare.py diffs two such files.
+
+namespace {
+
+// Every square against the occupancy of each perft position
+template <PieceType p>
+void BM_SliderAttacks(benchmark::State& state) {
+    std::vector<U64> occupancies;
+    for (auto& fen : FENS) occupancies.push_back(Board(fen).occupancy());
+
+    for (auto _ : state) {
+        for (U64 occ : occupancies) {
+            for (int sq = A1; sq <= H8; ++sq) {
+                if constexpr (p == ROOK)
+                    benchmark::DoNotOptimize(Magics::getRookAttacks(Square(sq), occ));
+                else
+                    benchmark::DoNotOptimize(Magics::getBishopAttacks(Square(sq), occ));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * occupancies.size() * 64);
+}
+
+// The sliders actually on the board of every bench position, to compare
+// the magic and PEXT backends on realistic lookups
+using SliderLookup = U64 (*)(Square, U64);
+
+template <SliderLookup rook, SliderLookup bishop>
+void BM_SliderBackend(benchmark::State& state) {
+    std::vector<std::pair<Square, U64>> rooks, bishops;
+    for (auto fen : Bench::POSITIONS) {
+        Board board(fen);
+        for (Color c : {WHITE, BLACK}) {
+            for (U64 b = board.straightSliders(c); b; b &= b - 1)
+                rooks.emplace_back(Square(BB::lsb(b)), board.occupancy());
+            for (U64 b = board.diagonalSliders(c); b; b &= b - 1)
+                bishops.emplace_back(Square(BB::lsb(b)), board.occupancy());
+        }
+    }
+
+    for (auto _ : state) {
+        for (auto& [sq, occ] : rooks) benchmark::DoNotOptimize(rook(sq, occ));
+        for (auto& [sq, occ] : bishops) benchmark::DoNotOptimize(bishop(sq, occ));
+    }
+    state.SetItemsProcessed(state.iterations() * (rooks.size() + bishops.size()));
+}
+
+// Union of the slider attacks of each side of every bench position, by
+// looking up each slider or setwise
+template <bool setwise>
+void BM_SliderUnion(benchmark::State& state) {
+    struct Side {
+        U64 straight, diagonal, occ;
+    };
+    std::vector<Side> sides;
+    for (auto fen : Bench::POSITIONS) {
+        Board board(fen);
+        for (Color c : {WHITE, BLACK})
+            sides.push_back({board.straightSliders(c), board.diagonalSliders(c), board.occupancy()});
+    }
+
+    for (auto _ : state) {
+        for (auto& side : sides) {
+            if constexpr (setwise) {
+                benchmark::DoNotOptimize(
+                    BB::slidingAttacks(side.straight, side.diagonal, side.occ));
+            } else {
+                U64 attacks = 0;
+                for (U64 b = side.straight; b; b &= b - 1)
+                    attacks |= BB::movesByPiece<ROOK>(BB::lsb(b), side.occ);
+                for (U64 b = side.diagonal; b; b &= b - 1)
+                    attacks |= BB::movesByPiece<BISHOP>(BB::lsb(b), side.occ);
+                benchmark::DoNotOptimize(attacks);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * sides.size());
+}
+
+template <PieceType p>
+void BM_MovesByPiece(benchmark::State& state) {
+    U64 occ = Board(POS2).occupancy();
+    for (auto _ : state) {
+        for (int sq = A1; sq <= H8; ++sq)
+            benchmark::DoNotOptimize(BB::movesByPiece<p>(Square(sq), occ));
+    }
+    state.SetItemsProcessed(state.iterations() * 64);
+}
+
+std::vector<Move> pseudoLegalMoves(Chess& chess) {
+    MoveGenerator movegen(&chess);
+    movegen.generatePseudoLegalMoves();
+    return movegen.moves;
+}
+
+std::vector<Move> legalMoves(Chess& chess) {
+    std::vector<Move> moves;
+    for (auto& move : pseudoLegalMoves(chess)) {
+        if (chess.isPseudoLegalMoveLegal(move)) moves.push_back(move);
+    }
+    return moves;
+}
+
+void BM_MakeUnmake(benchmark::State& state) {
+    Chess chess(POS2);
+    auto moves = legalMoves(chess);
+    for (auto _ : state) {
+        for (auto& move : moves) {
+            chess.make(move);
+            chess.unmake();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * moves.size());
+}
+
+void BM_IsCheckingMove(benchmark::State& state) {
+    Chess chess(POS2);
+    auto moves = legalMoves(chess);
+    for (auto _ : state) {
+        for (auto& move : moves) benchmark::DoNotOptimize(chess.isCheckingMove(move));
+    }
+    state.SetItemsProcessed(state.iterations() * moves.size());
+}
+
+void BM_IsPseudoLegalMoveLegal(benchmark::State& state) {
+    Chess chess(POS2);
+    auto moves = pseudoLegalMoves(chess);
+    for (auto _ : state) {
+        for (auto& move : moves) benchmark::DoNotOptimize(chess.isPseudoLegalMoveLegal(move));
+    }
+    state.SetItemsProcessed(state.iterations() * moves.size());
+}
+
+void BM_GeneratePseudoLegalMoves(benchmark::State& state) {
+    Chess chess(FENS[state.range(0)]);
+    for (auto _ : state) {
+        MoveGenerator movegen(&chess);
+        movegen.generatePseudoLegalMoves();
+        benchmark::DoNotOptimize(movegen.moves.size());
+    }
+}
+
+// Legal move counts of the positions after every move from the bench
+// positions, one at a time through MoveGenerator or all together
+std::vector<Chess> benchChildren() {
+    std::vector<Chess> children;
+    for (auto fen : Bench::POSITIONS) {
+        Chess chess(fen);
+        for (auto& move : legalMoves(chess)) {
+            chess.make(move);
+            children.push_back(chess);
+            chess.unmake();
+        }
+    }
+    return children;
+}
+
+void BM_CountMovesMoveGen(benchmark::State& state) {
+    auto positions = benchChildren();
+    for (auto _ : state) {
+        for (auto& chess : positions) {
+            MoveGenerator movegen(&chess);
+            movegen.generatePseudoLegalMoves();
+            U32 legal = 0;
+            for (auto& move : movegen.moves) legal += chess.isPseudoLegalMoveLegal(move);
+            benchmark::DoNotOptimize(legal);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+
+void BM_CountMovesBatch(benchmark::State& state) {
+    BoardBatch batch;
+    for (auto& chess : benchChildren()) batch.add(chess);
+    std::vector<U32> pseudoLegal(batch.size()), legal(batch.size());
+    for (auto _ : state) {
+        batch.countMoves(pseudoLegal.data(), legal.data());
+        benchmark::DoNotOptimize(legal.data());
+    }
+    state.SetItemsProcessed(state.iterations() * batch.size());
+}
+
+void BM_Eval(benchmark::State& state) {
+    Chess chess(FENS[state.range(0)]);
+    for (auto _ : state) benchmark::DoNotOptimize(chess.eval<false>());
+}
+
+// Loading and printing the bench positions, as bulk dataset jobs do
+void BM_FENConstruct(benchmark::State& state) {
+    for (auto _ : state)
+        for (auto fen : Bench::POSITIONS) benchmark::DoNotOptimize(Chess(fen).getKey());
+    state.SetItemsProcessed(state.iterations() * std::size(Bench::POSITIONS));
+}
+
+void BM_FENSet(benchmark::State& state) {
+    Chess chess(STARTFEN);
+    for (auto _ : state) {
+        for (auto fen : Bench::POSITIONS) {
+            chess.setFromFEN(fen);
+            benchmark::DoNotOptimize(chess.getKey());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * std::size(Bench::POSITIONS));
+}
+
+void BM_FENToString(benchmark::State& state) {
+    std::vector<Chess> positions;
+    for (auto fen : Bench::POSITIONS) positions.emplace_back(fen);
+    for (auto _ : state)
+        for (auto& chess : positions) benchmark::DoNotOptimize(chess.toFEN());
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+
+void BM_FENToBuffer(benchmark::State& state) {
+    std::vector<Chess> positions;
+    for (auto fen : Bench::POSITIONS) positions.emplace_back(fen);
+    char buffer[Chess::MAX_FEN];
+    for (auto _ : state) {
+        for (auto& chess : positions) {
+            benchmark::DoNotOptimize(chess.toFEN(buffer));
+            benchmark::ClobberMemory();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+
+// A GUI resending a whole game, as a new game every time so all of its
+// moves are parsed and played
+void BM_UCIPositionLongGame(benchmark::State& state) {
+    Chess chess(STARTFEN);
+    std::string game = "position startpos moves";
+    int plies = 0;
+    for (; plies < 300; ++plies) {
+        auto moves = legalMoves(chess);
+        if (moves.empty()) break;
+        Move move = moves[plies * 7 % moves.size()];
+        chess.make(move);
+        std::ostringstream oss;
+        oss << move;
+        game += " " + oss.str();
+    }
+
+    std::istringstream input;
+    std::ostringstream output;
+    UCI::Controller controller(input, output);
+    std::string other = "position fen " + std::string(POS2);
+    for (auto _ : state) {
+        controller.execute(other);
+        controller.execute(game);
+    }
+    state.SetItemsProcessed(state.iterations() * plies);
+}
+
+// Keys spread over the whole table, so most probes miss the cache
+void BM_TTSave(benchmark::State& state) {
+    TT::Table table;
+    U64 key = 0x9E3779B97F4A7C15ULL;
+    for (auto _ : state) {
+        key = key * 6364136223846793005ULL + 1442695040888963407ULL;
+        table.save(key, 5, 100, TT_EXACT, Move(E2, E4));
+    }
+}
+
+void BM_TTProbe(benchmark::State& state) {
+    TT::Table table;
+    U64 key = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < 1 << 16; ++i) {
+        key = key * 6364136223846793005ULL + 1442695040888963407ULL;
+        table.save(key, 5, 100, TT_EXACT, Move(E2, E4));
+    }
+    for (auto _ : state) {
+        key = key * 6364136223846793005ULL + 1442695040888963407ULL;
+        benchmark::DoNotOptimize(table.probe(key));
+    }
+}
+
+}  // namespace
+
+BENCHMARK(BM_SliderAttacks<ROOK>);
+BENCHMARK(BM_SliderAttacks<BISHOP>);
+BENCHMARK(BM_SliderBackend<Magics::getRookAttacksMagic, Magics::getBishopAttacksMagic>)
+    ->Name("BM_SliderBackend/magic");
+#ifdef USE_PEXT
+BENCHMARK(BM_SliderBackend<Magics::getRookAttacksPext, Magics::getBishopAttacksPext>)
+    ->Name("BM_SliderBackend/pext");
+#endif
+BENCHMARK(BM_SliderUnion<false>)->Name("BM_SliderUnion/lookup");
+BENCHMARK(BM_SliderUnion<true>)->Name("BM_SliderUnion/setwise");
+BENCHMARK(BM_MovesByPiece<KNIGHT>);
+BENCHMARK(BM_MovesByPiece<QUEEN>);
+BENCHMARK(BM_MakeUnmake);
+BENCHMARK(BM_IsCheckingMove);
+BENCHMARK(BM_IsPseudoLegalMoveLegal);
+BENCHMARK(BM_GeneratePseudoLegalMoves)->DenseRange(0, 5);
+BENCHMARK(BM_CountMovesMoveGen);
+BENCHMARK(BM_CountMovesBatch);
+BENCHMARK(BM_Eval)->DenseRange(0, 5);
+BENCHMARK(BM_FENConstruct);
+BENCHMARK(BM_FENSet);
+BENCHMARK(BM_FENToString);
+BENCHMARK(BM_FENToBuffer);
+BENCHMARK(BM_UCIPositionLongGame);
+BENCHMARK(BM_TTSave);
+BENCHMARK(BM_TTProbe);
+
+int main(int argc, char** argv) {
+    if (!Magics::verify()) return 1;
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "threadpool.hpp"
+#include "tune.hpp"
+
+// Texel tuning of the parameters in evalparams.hpp
+//
+//   tune convert <labeled.epd> <positions.bin>
+//   tune run <positions.bin> <evalparams.hpp> [epochs] [rate] [threads]
+
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+
+    if (mode == "convert" && argc == 4) {
+        std::ifstream is(argv[2]);
+        if (!is) {
+            std::cerr << "cannot open " << argv[2] << std::endl;
+            return 1;
+        }
+
+        Tune::Dataset data;
+        size_t skipped = data.convert(is);
+        if (!data.save(argv[3])) {
+            std::cerr << "cannot write " << argv[3] << std::endl;
+            return 1;
+        }
+        std::cout << "positions " << data.size() << " skipped " << skipped << std::endl;
+        return 0;
+    }
+
+    if (mode == "run" && argc >= 4) {
+        int epochs = argc > 4 ? std::stoi(argv[4]) : 1000;
+        double rate = argc > 5 ? std::stod(argv[5]) : 1.0;
+        size_t threads = argc > 6 ? std::stoul(argv[6]) : std::thread::hardware_concurrency();
+
+        Tune::Dataset data;
+        if (!data.load(argv[2])) {
+            std::cerr << "cannot load " << argv[2] << std::endl;
+            return 1;
+        }
+
+        ThreadPool pool(threads);
+        Tune::Params params = Tune::initialParams();
+        Tune::tune(data, params, epochs, rate, pool, std::cout);
+
+        std::ofstream os(argv[3]);
+        Tune::writeHeader(os, params);
+        return os ? 0 : 1;
+    }
+
+    std::cerr << "usage: tune convert <labeled.epd> <positions.bin>\n"
+                 "       tune run <positions.bin> <evalparams.hpp> [epochs] [rate] [threads]"
+              << std::endl;
+    return 1;
+}